@@ -0,0 +1,6 @@
+; file include/broken.as - a macro closing after a macro definition
+macr clear r
+mov #0, r
+endmacr
+
+endmacr
@@ -0,0 +1,5 @@
+;this file will include errors- an error inside an included file
+;the error is reported with the name and the line of the included file
+.include "include/broken.as"
+MAIN: clear r1
+stop
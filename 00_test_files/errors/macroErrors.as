@@ -0,0 +1,17 @@
+;this file will include errors- a macro that uses a macro defined after it
+;the uses of other macros in a macro are expanded when it is defined
+macr swap a, b
+mov a, r7
+mov b, a
+mov r7, b
+endmacr
+MAIN: swap r1, r2
+macr aa
+bb
+endmacr
+aa
+macr bb
+inc r1
+endmacr
+aa
+stop
@@ -0,0 +1,11 @@
+; file include/stack.as - macros shared by the valid samples
+.include "stack.as"
+.extern PRINT
+macr push v
+mov v, r7
+add r7, r6
+endmacr
+macr call f, v
+push v
+jsr f
+endmacr
@@ -0,0 +1,17 @@
+; file valid_03.as - macros with parameters
+.entry LIST
+macr swap a, b
+mov a, r7
+mov b, a
+mov r7, b
+endmacr
+macr text name
+name: .string "name"
+endmacr
+MAIN: add r3, LIST
+swap r1, r2
+swap LIST, K
+text STR
+stop
+LIST: .data 6, -9
+K: .data 31
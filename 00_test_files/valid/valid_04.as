@@ -0,0 +1,21 @@
+; file valid_04.as - macros that use other macros
+.extern OUT
+macr push v
+mov v, r7
+add r7, r6
+endmacr
+macr pair a, b
+push a
+push #3
+prn b
+endmacr
+macr quad x
+pair x, r1
+pair r2, x
+endmacr
+MAIN: add r3, r4
+quad K
+quad r5
+pair K, OUT
+stop
+K: .data 31
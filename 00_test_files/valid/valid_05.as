@@ -0,0 +1,9 @@
+; file valid_05.as - included files
+.include "include/stack.as"
+.include "include/stack.as"
+.entry MAIN
+MAIN: lea K, r6
+call PRINT, K
+call PRINT, #12
+stop
+K: .data 31
@@ -0,0 +1,436 @@
+#include "data.h"
+
+/**
+ * cases: The cases of the list, in the order of the list.
+ * order: The positions of the cases in the run order, sorted by their programs so the cases of a program run one after the other.
+ * casesCount: The number of cases.
+ * workers: The workers of the run, worker 0 is the main thread.
+ * workersCount: The number of workers.
+ */
+static BatchCase *cases = NULL;
+static long *order = NULL;
+static long casesCount = 0;
+static BatchWorker *workers = NULL;
+static int workersCount = 0;
+
+/**
+ * readList
+ * --------
+ * Reads a --batch list into a buffer, and splits it into its cases. Each line is a case: the name of a .ob
+ * file, optionally followed by a space or a tab and the input its red instructions read (the rest of the line).
+ * Empty lines and lines that start with ';' are skipped.
+ *
+ * Parameters:
+ * - fileName: The name of the list.
+ * - text: The buffer the list is read into, the cases point into it.
+ *
+ * Returns:
+ * - Bool: False if the list could not be read or the memory could not be allocated.
+ */
+static Bool readList(char *fileName, OutputBuffer *text)
+{
+    FILE *file = fopen(fileName, "r");
+    char *line, *next, *separator;
+    size_t count;
+    long i = 0;
+
+    if (file == NULL)
+        return False;
+
+    do
+    {
+        if (!reserveOutputBuffer(text, BUFSIZ + 1))
+        {
+            fclose(file);
+            return False;
+        }
+        count = fread(text->data + text->length, 1, BUFSIZ, file);
+        text->length += count;
+    } while (count == BUFSIZ);
+    fclose(file);
+    text->data[text->length] = '\0';
+
+    for (line = text->data; *line != '\0'; line = next + (*next != '\0'))
+    {
+        next = line + strcspn(line, "\n");
+        if (next > line && *line != ';')
+            casesCount++;
+    }
+
+    if (casesCount == 0 ||
+        (cases = (BatchCase *)calloc((size_t)casesCount, sizeof(BatchCase))) == NULL ||
+        (order = (long *)calloc((size_t)casesCount, sizeof(long))) == NULL)
+        return casesCount == 0 ? True : False;
+
+    for (line = text->data, count = 1; *line != '\0'; line = next + 1, count++)
+    {
+        next = line + strcspn(line, "\n");
+        if (next > line && next[-1] == '\r')
+            next[-1] = '\0';
+        if (*next == '\0')
+            next--; /* The last line has no new line, the loop ends after it */
+        else
+            *next = '\0';
+        if (*line == '\0' || *line == ';')
+            continue;
+
+        separator = line + strcspn(line, " \t");
+        cases[i].program = line;
+        cases[i].input = *separator != '\0' ? separator + 1 : separator;
+        cases[i].inputLength = strlen(cases[i].input);
+        *separator = '\0';
+        cases[i].line = (int)count;
+        order[i] = i;
+        i++;
+    }
+    casesCount = i; /* Lines of white space alone were counted but are not cases */
+    return True;
+}
+
+/**
+ * compareCases
+ * ------------
+ * Orders the positions of two cases by their programs, and by their positions for the cases of the same program.
+ */
+static int compareCases(const void *first, const void *second)
+{
+    long a = *(const long *)first, b = *(const long *)second;
+    int result = strcmp(cases[a].program, cases[b].program);
+    return result != 0 ? result : (a > b) - (a < b);
+}
+
+/**
+ * takeCase
+ * --------
+ * Takes the next case of a worker from the front of its queue. When its queue is empty, the worker steals
+ * the second half of the queue with the most cases left, so the cases of a program stay together.
+ *
+ * Parameters:
+ * - worker: The worker.
+ *
+ * Returns:
+ * - long: The index of the case in the list, or -1 if no worker has cases left.
+ */
+static long takeCase(BatchWorker *worker)
+{
+    BatchWorker *victim;
+    long left, mostLeft, stolen, first;
+    int i, chosen;
+
+    for (;;)
+    {
+        pthread_mutex_lock(&worker->lock);
+        if (worker->begin < worker->end)
+        {
+            left = order[worker->begin++];
+            pthread_mutex_unlock(&worker->lock);
+            return left;
+        }
+        pthread_mutex_unlock(&worker->lock);
+
+        for (i = 0, chosen = -1, mostLeft = 0; i < workersCount; i++)
+        {
+            pthread_mutex_lock(&workers[i].lock);
+            left = workers[i].end - workers[i].begin;
+            pthread_mutex_unlock(&workers[i].lock);
+            if (left > mostLeft)
+            {
+                mostLeft = left;
+                chosen = i;
+            }
+        }
+        if (chosen == -1)
+            return -1;
+
+        victim = &workers[chosen];
+        pthread_mutex_lock(&victim->lock);
+        stolen = (victim->end - victim->begin + 1) / 2; /* The victim may have taken cases since it was chosen */
+        first = victim->end -= stolen;
+        pthread_mutex_unlock(&victim->lock);
+
+        if (stolen > 0)
+        {
+            pthread_mutex_lock(&worker->lock);
+            worker->begin = first;
+            worker->end = first + stolen;
+            worker->steals++;
+            pthread_mutex_unlock(&worker->lock);
+        }
+    }
+}
+
+/**
+ * loadProgram
+ * -----------
+ * Loads the program of a case into the machine of a worker, and snapshots the machine so the next
+ * cases of the program restore it instead of loading it again. The output buffer of the machine is kept.
+ *
+ * Parameters:
+ * - worker: The worker.
+ * - program: The .ob file of the program.
+ */
+static void loadProgram(BatchWorker *worker, char *program)
+{
+    Machine *machine = worker->machine;
+    OutputBuffer output = machine->output;
+
+    initMachine(machine);
+    machine->output = output;
+    machine->output.length = 0;
+    machine->outputFile = NULL; /* The output is kept, and printed in the order of the list */
+
+    freeMachineSnapshot(worker->snapshot);
+    worker->program = program;
+    worker->isProgramLoaded = loadObFile(machine, program) && snapshotMachine(machine, worker->snapshot) ? True : False;
+}
+
+/**
+ * runCase
+ * -------
+ * Runs a case on the machine of a worker, from the snapshot of its program, and keeps its output at the end of the output of the worker.
+ *
+ * Parameters:
+ * - worker: The worker.
+ * - batchCase: The case.
+ */
+static void runCase(BatchWorker *worker, BatchCase *batchCase)
+{
+    Machine *machine = worker->machine;
+
+    clock_gettime(CLOCK_MONOTONIC, &batchCase->start);
+    batchCase->worker = (int)(worker - workers);
+
+    if (worker->program == NULL || strcmp(worker->program, batchCase->program))
+        loadProgram(worker, batchCase->program);
+    batchCase->isLoaded = worker->isProgramLoaded;
+
+    if (batchCase->isLoaded)
+    {
+        restoreMachine(machine, worker->snapshot);
+        machine->input = batchCase->input;
+        machine->inputLength = batchCase->inputLength;
+        batchCase->status = runMachine(machine);
+        batchCase->pc = machine->pc;
+        batchCase->steps = machine->steps;
+
+        batchCase->outputOffset = worker->output.length;
+        if (machine->output.length > 0 && reserveOutputBuffer(&worker->output, machine->output.length))
+        {
+            memcpy(worker->output.data + worker->output.length, machine->output.data, machine->output.length);
+            worker->output.length += machine->output.length;
+        }
+        batchCase->outputLength = worker->output.length - batchCase->outputOffset;
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &batchCase->end);
+}
+
+/**
+ * runWorker
+ * ---------
+ * Runs cases until no worker has cases left. It is the function of the threads of the workers.
+ *
+ * Parameters:
+ * - argument: The worker.
+ *
+ * Returns:
+ * - void*: NULL.
+ */
+static void *runWorker(void *argument)
+{
+    BatchWorker *worker = (BatchWorker *)argument;
+    long i;
+
+    while ((i = takeCase(worker)) != -1)
+        runCase(worker, &cases[i]);
+    return NULL;
+}
+
+/**
+ * getWorkersCount
+ * ---------------
+ * Returns the number of workers of the run: --jobs, or one per processor, and no more than the cases.
+ */
+static int getWorkersCount()
+{
+    long count = getJobs() > 0 ? getJobs() : sysconf(_SC_NPROCESSORS_ONLN);
+
+    if (count > casesCount)
+        count = casesCount;
+    return count < 1 ? 1 : (int)count;
+}
+
+/**
+ * startWorkers
+ * ------------
+ * Allocates the workers and their pools of machines and snapshots (once for the whole run), gives each worker
+ * an equal range of the run order, and starts their threads. Worker 0 runs on the main thread.
+ *
+ * Returns:
+ * - Bool: False if the memory could not be allocated.
+ */
+static Bool startWorkers()
+{
+    Machine *machines;
+    MachineSnapshot *snapshots;
+    int i;
+
+    workersCount = getWorkersCount();
+    workers = (BatchWorker *)calloc((size_t)workersCount, sizeof(BatchWorker));
+    machines = (Machine *)calloc((size_t)workersCount, sizeof(Machine));
+    snapshots = (MachineSnapshot *)calloc((size_t)workersCount, sizeof(MachineSnapshot));
+    if (workers == NULL || machines == NULL || snapshots == NULL)
+    {
+        free(workers);
+        free(machines);
+        free(snapshots);
+        workers = NULL;
+        return False;
+    }
+
+    for (i = 0; i < workersCount; i++)
+    {
+        pthread_mutex_init(&workers[i].lock, NULL);
+        workers[i].begin = casesCount * i / workersCount;
+        workers[i].end = casesCount * (i + 1) / workersCount;
+        workers[i].machine = &machines[i];
+        workers[i].snapshot = &snapshots[i];
+        initMachine(workers[i].machine);
+        initOutputBuffer(&workers[i].output);
+    }
+
+    /* A worker whose thread could not be started is left idle, the others steal its cases */
+    for (i = 1; i < workersCount; i++)
+        workers[i].isStarted = pthread_create(&workers[i].thread, NULL, runWorker, &workers[i]) == 0 ? True : False;
+    return True;
+}
+
+/**
+ * stopWorkers
+ * -----------
+ * Waits for the threads of the workers to end.
+ */
+static void stopWorkers()
+{
+    int i;
+
+    for (i = 1; i < workersCount; i++)
+        if (workers[i].isStarted)
+            pthread_join(workers[i].thread, NULL);
+}
+
+/**
+ * printResults
+ * ------------
+ * Prints the output of each case and how it ended, in the order of the list, and adds their spans to the
+ * trace. With --stats, the number of instructions of the batch and its wall clock time are printed too, with
+ * the heap use of the cases (that is counted apart from the source files).
+ *
+ * Parameters:
+ * - seconds: The wall clock time the cases took.
+ */
+static void printResults(double seconds)
+{
+    char name[MAX_FILENAME_LEN + MAX_DECIMAL_DIGITS + 16];
+    unsigned long steps = 0;
+    long i, steals = 0;
+
+    for (i = 0; i < casesCount; i++)
+    {
+        sprintf(name, "%.*s (line %d)", MAX_FILENAME_LEN, cases[i].program, cases[i].line);
+        traceBatchCase(name, cases[i].program, &cases[i].start, &cases[i].end, cases[i].worker);
+        if (!cases[i].isLoaded)
+        {
+            fflush(stdout);
+            fprintf(stderr, "\n%s\n", DIAGNOSTICS_SEPARATOR);
+            fprintf(stderr, " ERROR: Could not load object file %s\n", name);
+            fprintf(stderr, "%s\n\n", DIAGNOSTICS_SEPARATOR);
+            continue;
+        }
+
+        fwrite(workers[cases[i].worker].output.data + cases[i].outputOffset, 1, cases[i].outputLength, stdout);
+        reportProgramEnd(name, cases[i].status, cases[i].pc, cases[i].steps);
+        steps += cases[i].steps;
+    }
+
+    for (i = 0; i < workersCount; i++)
+        steals += workers[i].steals;
+    if (isStatsEnabled())
+    {
+        printf("  batch: %ld cases on %d workers (%ld steals), %lu instructions in %.3f ms, %.0f instructions/s\n",
+               casesCount, workersCount, steals, steps, seconds * 1000, seconds > 0 ? steps / seconds : 0);
+        printCaseAllocations();
+    }
+}
+
+/**
+ * freeBatch
+ * ---------
+ * Frees the cases, the workers and their pools.
+ */
+static void freeBatch()
+{
+    int i;
+
+    if (workers != NULL)
+    {
+        for (i = 0; i < workersCount; i++)
+        {
+            freeMachine(workers[i].machine);
+            freeMachineSnapshot(workers[i].snapshot);
+            freeOutputBuffer(&workers[i].output);
+            pthread_mutex_destroy(&workers[i].lock);
+        }
+        free(workers[0].machine);
+        free(workers[0].snapshot);
+        free(workers);
+    }
+    free(cases);
+    free(order);
+    workers = NULL;
+    cases = NULL;
+    order = NULL;
+    casesCount = 0;
+    workersCount = 0;
+}
+
+/**
+ * runBatch
+ * --------
+ * Runs the cases of a --batch list in parallel, and prints their outputs in the order of the list.
+ *
+ * Parameters:
+ * - fileName: The name of the list.
+ */
+void runBatch(char *fileName)
+{
+    OutputBuffer text;
+    struct timespec start, end;
+
+    initOutputBuffer(&text);
+    countCaseAllocations(True);
+    if (!readList(fileName, &text))
+    {
+        fprintf(stderr, "\n%s\n", DIAGNOSTICS_SEPARATOR);
+        fprintf(stderr, " ERROR: Could not read batch list %s\n", fileName);
+        fprintf(stderr, "%s\n\n", DIAGNOSTICS_SEPARATOR);
+    }
+    else if (casesCount > 0)
+    {
+        qsort(order, (size_t)casesCount, sizeof(long), compareCases);
+        if (!startWorkers())
+            reportError(memoryAllocationFailure);
+        else
+        {
+            clock_gettime(CLOCK_MONOTONIC, &start);
+            runWorker(&workers[0]);
+            stopWorkers();
+            clock_gettime(CLOCK_MONOTONIC, &end);
+            printResults((double)(end.tv_sec - start.tv_sec) + (double)(end.tv_nsec - start.tv_nsec) / 1e9);
+        }
+    }
+
+    freeBatch();
+    freeOutputBuffer(&text);
+    countCaseAllocations(False);
+}
@@ -0,0 +1,33 @@
+#!/bin/sh
+# Assembles generated corpora of growing sizes and records the throughput of the assembler
+# (source lines and memory words per second of the phases, as reported by --stats).
+# Each corpus is a set of programs that fit in the memory of the machine, assembled in one run.
+# Usage (from the repository root, after make and make generateProgram): sh benchmarks/bench.sh [lines...]
+
+SIZES=${*:-"1000 10000 100000"}
+OUT=benchmarks/out
+RESULTS=benchmarks/results.txt
+REVISION=$(git rev-parse --short HEAD 2>/dev/null || echo unknown)
+
+mkdir -p $OUT
+printf "%-10s %12s %14s %14s   %s\n" "lines" "time (ms)" "lines/s" "words/s" "revision" | tee -a $RESULTS
+
+for size in $SIZES; do
+    programs=$(sh benchmarks/generateCorpus.sh ./benchmarks/generateProgram $size $OUT/program_$size) || exit 1
+
+    ./main --stats $programs > $OUT/stats_$size.txt 2> $OUT/errors_$size.txt
+    if [ -s $OUT/errors_$size.txt ]; then
+        echo "The corpus of $size lines did not assemble cleanly, see $OUT/errors_$size.txt"
+        exit 1
+    fi
+
+    # The total time and the counters are read from the totals of the run, that follow their title
+    awk -v size=$size -v revision=$REVISION '
+        /^Stats for all/ { totals = 1; next }
+        totals && $1 == "total" { ms = $2 }
+        totals && $1 == "lines:" { gsub(",", ""); lines = $2; words = $6 }
+        END {
+            if (ms <= 0) ms = 0.001
+            printf "%-10s %12.1f %14.0f %14.0f   %s\n", size, ms, lines * 1000 / ms, words * 1000 / ms, revision
+        }' $OUT/stats_$size.txt | tee -a $RESULTS
+done
@@ -0,0 +1,37 @@
+#!/bin/sh
+# Runs generated loop programs on the two builds of the emulator, with the direct threaded dispatch
+# and with the switch dispatch (-DEMULATOR_SWITCH_DISPATCH), and records their instructions per second
+# (the best of three runs, as reported by --stats).
+# Usage (from the repository root, after make emubench builds the emulators): sh benchmarks/emubench.sh [body lines...]
+
+BODIES=${*:-"4 16 64"}
+LOOPS=1000
+OUT=benchmarks/out
+RESULTS=benchmarks/results.txt
+REVISION=$(git rev-parse --short HEAD 2>/dev/null || echo unknown)
+
+mkdir -p $OUT
+printf "%-10s %14s %16s %16s %8s   %s\n" "body" "instructions" "threaded/s" "switch/s" "speedup" "revision" | tee -a $RESULTS
+
+# bestRate prints the most instructions per second of three runs of an emulator on an object file
+bestRate() {
+    for run in 1 2 3; do
+        $1 --verbosity=quiet --stats $2 > $OUT/emulation.txt 2> $OUT/errors.txt
+        if [ -s $OUT/errors.txt ]; then
+            cat $OUT/errors.txt >&2
+            exit 1
+        fi
+        awk '$1 == "emulation:" { print $2, $7 }' $OUT/emulation.txt
+    done | sort -k 2 -n | tail -1
+}
+
+for body in $BODIES; do
+    program=$OUT/loop_$body
+    ./benchmarks/generateProgram -n $body -r $LOOPS -s 1 > $program.as || exit 1
+    ./benchmarks/emulatorThreaded --verbosity=quiet $program > /dev/null || exit 1
+
+    threaded=$(bestRate ./benchmarks/emulatorThreaded $program.ob) || exit 1
+    switched=$(bestRate ./benchmarks/emulatorSwitch $program.ob) || exit 1
+    echo "$body $threaded $switched $REVISION" | awk '{
+        printf "%-10s %14s %16.0f %16.0f %7.2fx   %s\n", $1, $2, $3, $5, ($5 > 0 ? $3 / $5 : 0), $6 }' | tee -a $RESULTS
+done
@@ -0,0 +1,19 @@
+#!/bin/sh
+# Generates a corpus of lines statements as programs of up to PART_LINES lines each (seeded 1, 2, ...),
+# since the memory image of a program must fit in the memory of the machine, and prints their names (without .as).
+# Usage: sh benchmarks/generateCorpus.sh generator lines prefix
+
+GENERATOR=$1
+LINES=$2
+PREFIX=$3
+PART_LINES=${PART_LINES:-1000}
+
+part=1
+left=$LINES
+while [ $left -gt 0 ]; do
+    size=$((left < PART_LINES ? left : PART_LINES))
+    [ -f ${PREFIX}_$part.as ] || "$GENERATOR" -n $size -s $part > ${PREFIX}_$part.as || { rm -f ${PREFIX}_$part.as; exit 1; }
+    echo ${PREFIX}_$part
+    left=$((left - size))
+    part=$((part + 1))
+done
@@ -0,0 +1,473 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*
+-----------------------------------------------------------------------------------------
+--------------------------- generateProgram.c General Overview: ---------------------------
+-----------------------------------------------------------------------------------------
+A generator of valid assembly programs, used as the workload of the benchmarks.
+The program is written to stdout and is the same for the same options and seed on every machine.
+Its memory image must fit in the memory of the machine, so a larger workload is generated as several
+programs (with different seeds) that are assembled together.
+
+Usage: generateProgram [-n lines] [-l labels%] [-x externs%] [-e entries%] [-m macros] [-u macro uses%]
+                       [-d data%] [-a immediate,direct,indirect,register] [-s seed] [-r loops]
+
+- lines: The number of statements (operations, data and macro uses) to generate.
+- labels%: The share of the statements that are declared with a label.
+- externs%: The share of the direct operands that use an external label.
+- entries%: The share of the labels that are declared as entries.
+- macros: The number of macros that are defined.
+- macro uses%: The share of the statements that are macro uses.
+- data%: The share of the statements that are .data or .string instructions.
+- immediate,direct,indirect,register: The weights of the addressing modes of the operands.
+- loops: Writes a program to run instead (the workload of the emulator benchmark): a body of lines
+  random operations on registers and data, in two nested loops of loops iterations each.
+
+The generator fails if the program it wrote does not fit in the memory (about 1300 lines with the default settings).
+-----------------------------------------------------------------------------------------
+*/
+
+#define MODES_COUNT 4
+#define OPERATIONS_COUNT 16
+#define EXTERNS_PER_LABELS 10
+#define MAX_LOOPS 2047
+#define LOOP_DATA_LABELS 8
+#define LOOP_BODY_OPERATIONS 9 /* mov to dec, the operations that do not jump or do input and output */
+#define MEMORY_START 100          /* As in the assembler's constants.h */
+#define RAM_MEMORY_SIZE 4096
+
+typedef enum
+{
+    immediate,
+    direct,
+    indirect,
+    registerMode
+} Mode;
+
+/* GeneratedOperation is an operation with the addressing modes it allows for each operand, as in the assembler's table */
+typedef struct
+{
+    char *name;
+    int src[MODES_COUNT];
+    int des[MODES_COUNT];
+} GeneratedOperation;
+
+/* Settings is what the command line options set */
+typedef struct
+{
+    long lines;
+    int labelsPercent;
+    int externsPercent;
+    int entriesPercent;
+    int macros;
+    int macroUsesPercent;
+    int dataPercent;
+    int modeWeights[MODES_COUNT];
+    unsigned long seed;
+    long loops;
+} Settings;
+
+static const GeneratedOperation operations[OPERATIONS_COUNT] = {
+    {"mov", {1, 1, 1, 1}, {0, 1, 1, 1}},
+    {"cmp", {1, 1, 1, 1}, {1, 1, 1, 1}},
+    {"add", {1, 1, 1, 1}, {0, 1, 1, 1}},
+    {"sub", {1, 1, 1, 1}, {0, 1, 1, 1}},
+    {"lea", {0, 1, 0, 0}, {0, 1, 1, 1}},
+    {"clr", {0, 0, 0, 0}, {0, 1, 1, 1}},
+    {"not", {0, 0, 0, 0}, {0, 1, 1, 1}},
+    {"inc", {0, 0, 0, 0}, {0, 1, 1, 1}},
+    {"dec", {0, 0, 0, 0}, {0, 1, 1, 1}},
+    {"jmp", {0, 0, 0, 0}, {0, 1, 1, 0}},
+    {"bne", {0, 0, 0, 0}, {0, 1, 1, 0}},
+    {"red", {0, 0, 0, 0}, {0, 1, 1, 1}},
+    {"prn", {0, 0, 0, 0}, {1, 1, 1, 1}},
+    {"jsr", {0, 0, 0, 0}, {0, 1, 1, 0}},
+    {"rts", {0, 0, 0, 0}, {0, 0, 0, 0}},
+    {"stop", {0, 0, 0, 0}, {0, 0, 0, 0}}};
+
+/**
+ * randomState: The state of the generator of the random numbers, a linear congruential generator
+ * that gives the same numbers on every machine (unlike rand).
+ */
+static unsigned long randomState = 1;
+
+/**
+ * imageWords: The number of memory words of the program written so far, as the assembler will encode it.
+ */
+static long imageWords = 0;
+
+/**
+ * nextRandom
+ * ----------
+ * Returns a random number in the range [0, limit).
+ */
+static long nextRandom(long limit)
+{
+    randomState = (randomState * 1103515245UL + 12345UL) & 0x7fffffffUL;
+    return limit > 0 ? (long)((randomState >> 8) % (unsigned long)limit) : 0;
+}
+
+/**
+ * isChance
+ * --------
+ * Returns 1 with a chance of percent out of 100.
+ */
+static int isChance(int percent)
+{
+    return nextRandom(100) < percent;
+}
+
+/**
+ * isLabeled
+ * ---------
+ * Checks if a statement is declared with a label. The labeled statements are spread evenly,
+ * so the number of labels is known before the program is written and any of them can be used.
+ *
+ * Parameters:
+ * - index: The index of the statement.
+ * - percent: The share of the labeled statements.
+ *
+ * Returns:
+ * - long: The index of the label of the statement, or -1 if it has none.
+ */
+static long isLabeled(long index, int percent)
+{
+    return (index * percent) / 100 != ((index + 1) * percent) / 100 ? (index * percent) / 100 : -1;
+}
+
+/**
+ * countOperation
+ * --------------
+ * Adds the words of an operation to the image words: the first word, and a word for each operand,
+ * except that two register operands (direct or indirect) share one.
+ *
+ * Parameters:
+ * - first: The first operand, or NULL if the operation has none.
+ * - second: The second operand, or NULL if the operation has at most one.
+ */
+static void countOperation(const char *first, const char *second)
+{
+    imageWords++;
+    if (first != NULL && second != NULL && (first[0] == 'r' || first[0] == '*') && (second[0] == 'r' || second[0] == '*'))
+        imageWords++;
+    else
+        imageWords += (first != NULL) + (second != NULL);
+}
+
+/**
+ * writeOperand
+ * ------------
+ * Writes an operand in one of the allowed addressing modes, picked by the mode weights.
+ *
+ * Parameters:
+ * - dst: The destination.
+ * - allowed: The addressing modes the operand allows.
+ * - settings: The settings of the program.
+ * - labels: The number of labels in the program.
+ * - externs: The number of external labels in the program.
+ */
+static void writeOperand(char *dst, const int allowed[MODES_COUNT], Settings *settings, long labels, long externs)
+{
+    int i, total = 0, pick;
+    Mode mode = direct;
+
+    for (i = 0; i < MODES_COUNT; i++)
+        total += allowed[i] ? settings->modeWeights[i] : 0;
+
+    if (total > 0)
+    {
+        pick = (int)nextRandom(total);
+        for (i = 0; i < MODES_COUNT; i++)
+        {
+            if (!allowed[i])
+                continue;
+            if (pick < settings->modeWeights[i])
+            {
+                mode = (Mode)i;
+                break;
+            }
+            pick -= settings->modeWeights[i];
+        }
+    }
+    else if (!allowed[direct])
+        mode = allowed[registerMode] ? registerMode : indirect;
+
+    if (mode == immediate)
+        sprintf(dst, "#%ld", nextRandom(201) - 100);
+    else if (mode == indirect)
+        sprintf(dst, "*r%ld", nextRandom(8));
+    else if (mode == registerMode)
+        sprintf(dst, "r%ld", nextRandom(8));
+    else if (externs > 0 && (labels == 0 || isChance(settings->externsPercent)))
+        sprintf(dst, "X%ld", nextRandom(externs));
+    else if (labels > 0)
+        sprintf(dst, "L%ld", nextRandom(labels));
+    else
+        sprintf(dst, "r%ld", nextRandom(8));
+}
+
+/**
+ * writeStatement
+ * --------------
+ * Writes a statement without its label: a .data or .string instruction, a macro use, or an operation.
+ * A labeled statement is never a macro use, since the assembler does not allow a label before it.
+ */
+static void writeStatement(Settings *settings, long labels, long externs, int isLabeledStatement)
+{
+    static const int any[MODES_COUNT] = {1, 1, 1, 1}, assignable[MODES_COUNT] = {0, 1, 0, 1};
+    char first[32], second[32];
+    const GeneratedOperation *op;
+    int i, count;
+
+    if (isChance(settings->dataPercent))
+    {
+        if (isChance(50))
+        {
+            count = 1 + (int)nextRandom(5);
+            printf(".data %ld", nextRandom(2001) - 1000);
+            for (i = 1; i < count; i++)
+                printf(", %ld", nextRandom(2001) - 1000);
+            printf("\n");
+            imageWords += count;
+        }
+        else
+        {
+            count = 1 + (int)nextRandom(20);
+            printf(".string \"");
+            for (i = 0; i < count; i++)
+                putchar('a' + (int)nextRandom(26));
+            printf("\"\n");
+            imageWords += count + 1; /* The string ends with a zero word */
+        }
+    }
+    else if (settings->macros > 0 && !isLabeledStatement && isChance(settings->macroUsesPercent))
+    {
+        writeOperand(first, any, settings, labels, externs);
+        writeOperand(second, assignable, settings, labels, externs);
+        printf("mac%ld %s, %s\n", nextRandom(settings->macros), first, second);
+        countOperation(first, "r7"); /* The body of every macro: mov a, r7 and add r7, b */
+        countOperation("r7", second);
+    }
+    else
+    {
+        op = &operations[nextRandom(OPERATIONS_COUNT - 1)]; /* stop only ends the program */
+        if (op->src[direct])
+        {
+            writeOperand(first, op->src, settings, labels, externs);
+            writeOperand(second, op->des, settings, labels, externs);
+            printf("%s %s, %s\n", op->name, first, second);
+            countOperation(first, second);
+        }
+        else if (op->des[direct])
+        {
+            writeOperand(first, op->des, settings, labels, externs);
+            printf("%s %s\n", op->name, first);
+            countOperation(first, NULL);
+        }
+        else
+        {
+            printf("%s\n", op->name);
+            countOperation(NULL, NULL);
+        }
+    }
+}
+
+/**
+ * writeLoopOperand
+ * ----------------
+ * Writes an operand of the body of a loop program: an immediate value (if allowed), one of the registers r0-r5
+ * (r6 and r7 count the loops, and no register is used as an address), or one of the data labels.
+ */
+static void writeLoopOperand(char *dst, int isImmediateAllowed)
+{
+    long pick = nextRandom(isImmediateAllowed ? 3 : 2);
+
+    if (pick == 2)
+        sprintf(dst, "#%ld", nextRandom(201) - 100);
+    else if (pick == 1)
+        sprintf(dst, "D%ld", nextRandom(LOOP_DATA_LABELS));
+    else
+        sprintf(dst, "r%ld", nextRandom(6));
+}
+
+/**
+ * writeLoopProgram
+ * ----------------
+ * Writes a program that runs to its end: lines random operations (mov, cmp, add, sub, lea, clr, not, inc and dec)
+ * in two nested loops, counted down in r7 and r6, that prints the registers before it stops.
+ */
+static void writeLoopProgram(Settings *settings)
+{
+    char first[32], second[32];
+    const GeneratedOperation *op;
+    long i;
+
+    printf("; generated by generateProgram -n %ld -s %lu -r %ld\n", settings->lines, settings->seed, settings->loops);
+    printf("MAIN: mov #%ld, r7\n", settings->loops);
+    printf("OUTER: mov #%ld, r6\n", settings->loops);
+    printf("INNER: ");
+    for (i = 0; i < settings->lines; i++)
+    {
+        op = &operations[nextRandom(LOOP_BODY_OPERATIONS)];
+        if (op->src[direct] && !op->src[immediate])
+        {
+            printf("lea D%ld, r%ld\n", nextRandom(LOOP_DATA_LABELS), nextRandom(6));
+            countOperation("D", "r");
+        }
+        else if (op->src[direct])
+        {
+            writeLoopOperand(first, 1);
+            writeLoopOperand(second, op->des[immediate]);
+            printf("%s %s, %s\n", op->name, first, second);
+            countOperation(first, second);
+        }
+        else
+        {
+            writeLoopOperand(first, 0);
+            printf("%s %s\n", op->name, first);
+            countOperation(first, NULL);
+        }
+    }
+    printf("dec r6\ncmp r6, #0\nbne INNER\ndec r7\ncmp r7, #0\nbne OUTER\n");
+    for (i = 0; i < 6; i++)
+        printf("prn r%ld\n", i);
+    printf("stop\n");
+    for (i = 0; i < LOOP_DATA_LABELS; i++)
+        printf("D%ld: .data %ld\n", i, nextRandom(2001) - 1000);
+    imageWords += 6 + 14 + 6 * 2 + 1 + LOOP_DATA_LABELS; /* The counters, the loops, the prints, stop and the data */
+}
+
+/**
+ * isImageTooLarge
+ * ---------------
+ * Checks if the image of the program written does not fit in the memory of the machine, and reports it.
+ *
+ * Returns:
+ * - int: 1 if the image is too large, 0 otherwise.
+ */
+static int isImageTooLarge(void)
+{
+    if (MEMORY_START + imageWords <= RAM_MEMORY_SIZE)
+        return 0;
+
+    fprintf(stderr, "The program takes %ld words, more than the %d words of the memory: generate fewer lines\n",
+            imageWords, RAM_MEMORY_SIZE - MEMORY_START);
+    return 1;
+}
+
+/**
+ * parseSettings
+ * -------------
+ * Reads the command line options into the settings.
+ *
+ * Returns:
+ * - int: 1 if the options are legal, 0 otherwise.
+ */
+static int parseSettings(int argc, char *argv[], Settings *settings)
+{
+    int i;
+    char *value;
+
+    for (i = 1; i < argc; i++)
+    {
+        if (argv[i][0] != '-' || argv[i][1] == '\0' || argv[i][2] != '\0' || i + 1 >= argc)
+            return 0;
+
+        value = argv[++i];
+        switch (argv[i - 1][1])
+        {
+        case 'n':
+            settings->lines = atol(value);
+            break;
+        case 'l':
+            settings->labelsPercent = atoi(value);
+            break;
+        case 'x':
+            settings->externsPercent = atoi(value);
+            break;
+        case 'e':
+            settings->entriesPercent = atoi(value);
+            break;
+        case 'm':
+            settings->macros = atoi(value);
+            break;
+        case 'u':
+            settings->macroUsesPercent = atoi(value);
+            break;
+        case 'd':
+            settings->dataPercent = atoi(value);
+            break;
+        case 's':
+            settings->seed = strtoul(value, NULL, 10);
+            break;
+        case 'r':
+            settings->loops = atol(value);
+            break;
+        case 'a':
+            if (sscanf(value, "%d,%d,%d,%d", &settings->modeWeights[immediate], &settings->modeWeights[direct],
+                       &settings->modeWeights[indirect], &settings->modeWeights[registerMode]) != MODES_COUNT)
+                return 0;
+            break;
+        default:
+            return 0;
+        }
+    }
+
+    return settings->lines > 0 && settings->labelsPercent >= 0 && settings->labelsPercent <= 100 && settings->macros >= 0 &&
+           settings->loops >= 0 && settings->loops <= MAX_LOOPS;
+}
+
+int main(int argc, char *argv[])
+{
+    Settings settings = {1000, 20, 10, 10, 4, 5, 15, {25, 25, 25, 25}, 1, 0};
+    long i, label, labels, externs;
+
+    if (!parseSettings(argc, argv, &settings))
+    {
+        fprintf(stderr, "Usage: %s [-n lines] [-l labels%%] [-x externs%%] [-e entries%%] [-m macros] [-u macro uses%%] "
+                        "[-d data%%] [-a immediate,direct,indirect,register] [-s seed] [-r loops]\n",
+                argv[0]);
+        return 1;
+    }
+
+    randomState = settings.seed;
+    if (settings.loops > 0)
+    {
+        writeLoopProgram(&settings);
+        return isImageTooLarge();
+    }
+
+    labels = (settings.lines * settings.labelsPercent) / 100;
+    externs = settings.externsPercent > 0 ? labels / EXTERNS_PER_LABELS + 1 : 0;
+
+    /* The assembler reads lines of up to 80 characters, so the settings are split over two comment lines */
+    printf("; generated by generateProgram -n %ld -s %lu\n", settings.lines, settings.seed);
+    printf("; -l %d -x %d -e %d -m %d -u %d -d %d -a %d,%d,%d,%d\n", settings.labelsPercent, settings.externsPercent,
+           settings.entriesPercent, settings.macros, settings.macroUsesPercent, settings.dataPercent, settings.modeWeights[immediate],
+           settings.modeWeights[direct], settings.modeWeights[indirect], settings.modeWeights[registerMode]);
+
+    for (i = 0; i < externs; i++)
+        printf(".extern X%ld\n", i);
+
+    for (i = 0; i < settings.macros; i++)
+        printf("macr mac%ld a, b\nmov a, r7\nadd r7, b\nendmacr\n", i);
+
+    for (i = 0; i < settings.lines - 1; i++)
+    {
+        if ((label = isLabeled(i, settings.labelsPercent)) != -1)
+            printf("L%ld: ", label);
+        writeStatement(&settings, labels, externs, label != -1);
+    }
+    if ((label = isLabeled(i, settings.labelsPercent)) != -1)
+        printf("L%ld: ", label);
+    printf("stop\n");
+    countOperation(NULL, NULL);
+
+    for (i = 0; i < labels; i++)
+        if (isChance(settings.entriesPercent))
+            printf(".entry L%ld\n", i);
+
+    return isImageTooLarge();
+}
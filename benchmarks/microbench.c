@@ -0,0 +1,291 @@
+#include "../data.h"
+
+/*
+-----------------------------------------------------------------------------------------
+--------------------------- microbench.c General Overview: ---------------------------
+-----------------------------------------------------------------------------------------
+Measures the hot functions of the assembler in isolation. Each function is called a fixed number
+of times (so two runs are comparable) on fixed inputs, and the time and the heap allocations per
+call are reported. It is linked with all the modules of the assembler except main.c, and built with
+-DTRACK_ALLOCATIONS so the allocations are counted (make microbench).
+
+Usage: microbench [scale]
+- scale: Multiplies the iterations of every function (1 by default).
+-----------------------------------------------------------------------------------------
+*/
+
+#define FIXTURE_SYMBOLS 200
+#define FIXTURE_WORDS 1000
+#define MICROBENCH_OB_FILE "microbench.ob"
+#define MICROBENCH_PROGRAM_FILE "microbench_program.ob"
+
+/* Microbenchmark is a function that is measured, run calls it iterations times and returns a value that depends on the calls */
+typedef struct
+{
+    char *name;
+    long iterations;
+    long (*run)(long iterations);
+} Microbenchmark;
+
+/**
+ * symbolNames: The names of the symbols in the fixture symbol table, a lookup of each of them is a hit.
+ * missingNames: Names that are not in the symbol table, a lookup of each of them is a miss.
+ * textBuffer: The destination of the memory image text.
+ * machine, snapshot: A machine with a small program loaded (it writes a data word and stops), and its snapshot.
+ * sink: Keeps the results of the calls, so the compiler does not drop them.
+ */
+static char symbolNames[FIXTURE_SYMBOLS][MAX_LABEL_LEN];
+static char missingNames[FIXTURE_SYMBOLS][MAX_LABEL_LEN];
+static OutputBuffer textBuffer;
+static Machine machine;
+static MachineSnapshot snapshot;
+static volatile long sink;
+
+/**
+ * setUpFixture
+ * ------------
+ * Builds the state the functions work on: a symbol table and a memory image.
+ */
+static void setUpFixture()
+{
+    int i;
+
+    initTables();
+    setGlobalState(firstRun);
+    for (i = 0; i < FIXTURE_SYMBOLS; i++)
+    {
+        sprintf(symbolNames[i], "LABEL%d", i);
+        sprintf(missingNames[i], "MISSING%d", i);
+        addSymbol(symbolNames[i], MEMORY_START + i, 1, 0, 0, 0);
+    }
+
+    resetMemoryCounters();
+    increaseInstructionCounter(FIXTURE_WORDS);
+    calcFinalAddrsCountersValues();
+    allocMemoryImg();
+    for (i = 0; i < FIXTURE_WORDS; i++)
+        addWord(i * 37, Code);
+
+    initOutputBuffer(&textBuffer);
+    reserveOutputBuffer(&textBuffer, getMemoryImageTextMaxLength());
+}
+
+/**
+ * setUpMachine
+ * ------------
+ * Writes the .ob file of a program of 4 code words and 1 data word (mov #5, DATA and stop),
+ * loads it into the fixture machine and snapshots the machine.
+ */
+static void setUpMachine()
+{
+    unsigned dataAddress = MEMORY_START + 4;
+    unsigned words[5];
+    FILE *file = fopen(MICROBENCH_PROGRAM_FILE, "w");
+    int i;
+
+    words[0] = ((unsigned)movOpcode << 11) | (IMMEDIATE_ADDR << 7) | (DIRECT_ADDR << 3) | A;
+    words[1] = (5 << 3) | A;
+    words[2] = (dataAddress << 3) | R;
+    words[3] = ((unsigned)stopOpcode << 11) | A;
+    words[4] = 0;
+
+    fprintf(file, "4 1\n");
+    for (i = 0; i < 5; i++)
+        fprintf(file, "%04u %05o\n", MEMORY_START + i, words[i]);
+    fclose(file);
+
+    initMachine(&machine);
+    loadObFile(&machine, MICROBENCH_PROGRAM_FILE);
+    machine.outputFile = NULL;
+    snapshotMachine(&machine, &snapshot);
+}
+
+static long runHash(long iterations)
+{
+    long i, sum = 0;
+    for (i = 0; i < iterations; i++)
+        sum += hash(symbolNames[i % FIXTURE_SYMBOLS]);
+    return sum;
+}
+
+static long runLookupHit(long iterations)
+{
+    long i, sum = 0;
+    for (i = 0; i < iterations; i++)
+        sum += lookup(symbolNames[i % FIXTURE_SYMBOLS], Symbol) != NULL;
+    return sum;
+}
+
+static long runLookupMiss(long iterations)
+{
+    long i, sum = 0;
+    for (i = 0; i < iterations; i++)
+        sum += lookup(missingNames[i % FIXTURE_SYMBOLS], Symbol) != NULL;
+    return sum;
+}
+
+static long runGetOpIndex(long iterations)
+{
+    static char *names[] = {"mov", "lea", "jsr", "stop", "LOOP"};
+    long i, sum = 0;
+    for (i = 0; i < iterations; i++)
+        sum += getOpIndex(names[i % 5]);
+    return sum;
+}
+
+static long runIsRegistery(long iterations)
+{
+    static char *names[] = {"r0", "r7", "r8", "LIST"};
+    long i, sum = 0;
+    for (i = 0; i < iterations; i++)
+        sum += isRegistery(names[i % 4]);
+    return sum;
+}
+
+static long runVerifyLabelNaming(long iterations)
+{
+    long i, sum = 0;
+    for (i = 0; i < iterations; i++)
+        sum += verifyLabelNaming(symbolNames[i % FIXTURE_SYMBOLS]);
+    return sum;
+}
+
+static long runVerifyCommaSyntax(long iterations)
+{
+    long i, sum = 0;
+    char line[MAX_LINE_LEN];
+    for (i = 0; i < iterations; i++)
+    {
+        strcpy(line, " 6, -9, 15, 31, -100");
+        sum += verifyCommaSyntax(line);
+    }
+    return sum;
+}
+
+static long runCountAndVerifyDataArguments(long iterations)
+{
+    long i, sum = 0;
+    char line[MAX_LINE_LEN];
+    for (i = 0; i < iterations; i++)
+    {
+        strcpy(line, ".data 6, -9, 15, 31, -100"); /* The line is tokenized in place, so it is copied each time */
+        sum += countAndVerifyDataArguments(line);
+    }
+    return sum;
+}
+
+static long runFormatDecimal(long iterations)
+{
+    long i, sum = 0;
+    char text[MAX_DECIMAL_DIGITS + 1];
+    for (i = 0; i < iterations; i++)
+        sum += formatDecimal(text, (unsigned)(MEMORY_START + i % RAM_MEMORY_SIZE), OB_ADDRESS_MIN_DIGITS);
+    return sum;
+}
+
+static long runFormatMemoryImageWords(long iterations)
+{
+    long i, sum = 0;
+    for (i = 0; i < iterations; i++)
+        sum += (long)formatMemoryImageWords(textBuffer.data);
+    return sum;
+}
+
+static long runCreateObFile(long iterations)
+{
+    long i;
+    for (i = 0; i < iterations; i++)
+        createObFile(MICROBENCH_OB_FILE);
+    unlink(MICROBENCH_OB_FILE);
+    return iterations;
+}
+
+static long runReloadMachine(long iterations)
+{
+    long i, sum = 0;
+    for (i = 0; i < iterations; i++)
+    {
+        initMachine(&machine);
+        loadObFile(&machine, MICROBENCH_PROGRAM_FILE);
+        machine.outputFile = NULL;
+        sum += runMachine(&machine);
+    }
+    snapshotMachine(&machine, &snapshot); /* The reloaded machine is not tracked against the snapshot anymore */
+    return sum;
+}
+
+static long runRestoreMachine(long iterations)
+{
+    long i, sum = 0;
+    for (i = 0; i < iterations; i++)
+    {
+        sum += runMachine(&machine);
+        restoreMachine(&machine, &snapshot);
+    }
+    return sum;
+}
+
+/**
+ * getNanoseconds
+ * --------------
+ * Returns the time of a monotonic clock, in nanoseconds.
+ */
+static double getNanoseconds()
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (double)now.tv_sec * 1e9 + (double)now.tv_nsec;
+}
+
+int main(int argc, char *argv[])
+{
+    /* The memory image functions replaced numToBin, convertBinaryWordToOctal and writeMemoryImageToObFile */
+    static Microbenchmark benchmarks[] = {
+        {"hash", 2000000, runHash},
+        {"lookup (hit)", 2000000, runLookupHit},
+        {"lookup (miss)", 2000000, runLookupMiss},
+        {"getOpIndex", 2000000, runGetOpIndex},
+        {"isRegistery", 2000000, runIsRegistery},
+        {"verifyLabelNaming", 1000000, runVerifyLabelNaming},
+        {"verifyCommaSyntax", 1000000, runVerifyCommaSyntax},
+        {"countAndVerifyDataArguments", 500000, runCountAndVerifyDataArguments},
+        {"formatDecimal", 2000000, runFormatDecimal},
+        {"formatMemoryImageWords (1000 words)", 5000, runFormatMemoryImageWords},
+        {"createObFile (1000 words)", 500, runCreateObFile},
+        {"run after loadObFile (5 words)", 20000, runReloadMachine},
+        {"run after restoreMachine (5 words)", 2000000, runRestoreMachine}};
+    long scale = argc > 1 ? atol(argv[1]) : 1, iterations, allocations;
+    double start, elapsed;
+    int i;
+
+    if (scale < 1)
+    {
+        fprintf(stderr, "Usage: %s [scale]\n", argv[0]);
+        return 1;
+    }
+
+    setUpFixture();
+    setUpMachine();
+    printf("%-38s %12s %12s %14s\n", "function", "iterations", "ns/op", "allocs/op");
+
+    for (i = 0; i < (int)(sizeof(benchmarks) / sizeof(benchmarks[0])); i++)
+    {
+        iterations = benchmarks[i].iterations * scale;
+        benchmarks[i].run(iterations / 100 + 1); /* Warm up the caches */
+
+        allocations = getAllocationsCount();
+        start = getNanoseconds();
+        sink += benchmarks[i].run(iterations);
+        elapsed = getNanoseconds() - start;
+        allocations = getAllocationsCount() - allocations;
+
+        printf("%-38s %12ld %12.1f %14.3f\n", benchmarks[i].name, iterations, elapsed / iterations, (double)allocations / iterations);
+    }
+
+    unlink(MICROBENCH_PROGRAM_FILE);
+    freeMachineSnapshot(&snapshot);
+    freeMachine(&machine);
+    freeOutputBuffer(&textBuffer);
+    freeHashTable(Symbol);
+    return 0;
+}
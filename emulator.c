@@ -0,0 +1,907 @@
+#include "data.h"
+
+/**
+ * statusMessages: The text of each MachineStatus, in the order of the enum.
+ * standardInput: The standard input, read once on the first red instruction of the run and shared by
+ * all the programs that are run (each of them reads it from its start).
+ * isStandardInputRead: Whether the standard input was read.
+ */
+static char *statusMessages[] = {"running", "stopped", "illegal instruction", "address out of memory",
+                                 "reference to an external symbol", "stack overflow", "return with an empty stack",
+                                 "instructions limit reached"};
+static OutputBuffer standardInput;
+static Bool isStandardInputRead = False;
+
+/**
+ * toSigned
+ * --------
+ * Returns the signed value of a word, whose bit 14 is the sign bit.
+ */
+static int toSigned(Word word)
+{
+    return word & (1 << (BINARY_WORD_SIZE - 1)) ? (int)word - (1 << BINARY_WORD_SIZE) : (int)word;
+}
+
+/**
+ * getOperandKind
+ * --------------
+ * Finds the kind of an operand from its addressing method in the first word of an instruction.
+ *
+ * Parameters:
+ * - method: The addressing method bits (one of IMMEDIATE_ADDR, DIRECT_ADDR, INDIRECT_ADDR and REGISTER_DIRECT_ADDR, or 0 for none).
+ * - allowed: The addressing methods the operation allows for the operand.
+ *
+ * Returns:
+ * - int: The OperandKind, or -1 if the method is not one the operation allows.
+ */
+static int getOperandKind(unsigned method, AddrMethodsOptions allowed)
+{
+    Bool hasOperand = allowed.immediate || allowed.direct || allowed.indirect || allowed.reg ? True : False;
+
+    if (method == 0)
+        return hasOperand ? -1 : noOperand;
+    if (method == IMMEDIATE_ADDR && allowed.immediate)
+        return immediateOperand;
+    if (method == DIRECT_ADDR && allowed.direct)
+        return directOperand;
+    if (method == INDIRECT_ADDR && allowed.indirect)
+        return indirectOperand;
+    if (method == REGISTER_DIRECT_ADDR && allowed.reg)
+        return registerOperand;
+    return -1;
+}
+
+/**
+ * decodeOperandWord
+ * -----------------
+ * Decodes the value of an operand from its word, as writeSecondAndThirdWords encodes it.
+ *
+ * Parameters:
+ * - word: The operand word.
+ * - kind: The kind of the operand, a direct operand of an external symbol is changed to externalOperand.
+ * - registerShift: The position of the register number in the word (6 for a source operand, 3 for a destination operand).
+ * - value: Where the value of the operand is written.
+ *
+ * Returns:
+ * - Bool: True if the word is a legal word of an operand of this kind.
+ */
+static Bool decodeOperandWord(Word word, unsigned char *kind, int registerShift, Word *value)
+{
+    unsigned field = (word >> 3) & ((1 << IMMEDIATE_VALUE_BITS) - 1);
+
+    if (*kind == immediateOperand)
+    {
+        if (field & (1 << (IMMEDIATE_VALUE_BITS - 1)))
+            field |= ~((1u << IMMEDIATE_VALUE_BITS) - 1); /* Extend the sign of the 12 bits value */
+        *value = (Word)(field & WORD_MASK);
+        return (word & (A | R | E)) == A ? True : False;
+    }
+    if (*kind == directOperand)
+    {
+        if ((word & (A | R | E)) == E)
+            *kind = externalOperand;
+        *value = (Word)field;
+        return (word & (A | R | E)) == R || (word & (A | R | E)) == E ? True : False;
+    }
+
+    *value = (Word)((word >> registerShift) & (REGS_SIZE - 1));
+    return (word & (A | R | E)) == A ? True : False;
+}
+
+/**
+ * getOperandCell
+ * --------------
+ * Finds the register or the memory word an operand refers to (the decoded value itself for an immediate operand).
+ *
+ * Returns:
+ * - Word*: The register or the memory word, or NULL if the operand is an external symbol or an address out of the memory.
+ */
+static Word *getOperandCell(Machine *machine, unsigned char kind, Word *value)
+{
+    switch (kind)
+    {
+    case immediateOperand:
+        return value;
+    case directOperand:
+        return &machine->memory[*value];
+    case registerOperand:
+        return &machine->registers[*value];
+    case indirectOperand:
+        return machine->registers[*value] < RAM_MEMORY_SIZE ? &machine->memory[machine->registers[*value]] : NULL;
+    default:
+        return NULL;
+    }
+}
+
+/**
+ * resolveOperandCell
+ * ------------------
+ * Finds the word an operand of a decoded instruction refers to before the instruction runs, which is
+ * possible unless the operand is indirect (the register may change) or external.
+ *
+ * Parameters:
+ * - machine: The machine.
+ * - kind: The kind of the operand.
+ * - value: The decoded value of the operand.
+ * - cell: Where the offset of the word from the start of the machine is written.
+ *
+ * Returns:
+ * - Bool: True if the word is known.
+ */
+static Bool resolveOperandCell(Machine *machine, unsigned char kind, Word *value, unsigned short *cell)
+{
+    Word *word = kind == noOperand ? value : getOperandCell(machine, kind, value);
+
+    if (kind == indirectOperand || word == NULL)
+        return False;
+    *cell = (unsigned short)(word - (Word *)machine);
+    return True;
+}
+
+/**
+ * decodeInstruction
+ * -----------------
+ * Decodes the instruction that starts at an address of the memory, as writeFirstWord and
+ * writeSecondAndThirdWords encode it, into the decoded instruction of the address.
+ *
+ * Parameters:
+ * - machine: The machine.
+ * - address: The address of the first word of the instruction.
+ *
+ * Returns:
+ * - Bool: True if the words are a legal instruction, False otherwise (the instruction is left undecoded).
+ */
+static Bool decodeInstruction(Machine *machine, unsigned address)
+{
+    DecodedInstruction *instruction = &machine->decoded[address];
+    Word word = machine->memory[address];
+    const Operation *op = getOperationByIndex((word >> 11) & (OP_SIZE - 1));
+    int srcKind = getOperandKind((word >> 7) & 0xF, op->src), dstKind = getOperandKind((word >> 3) & 0xF, op->des);
+    unsigned next = address + 1;
+    Bool isLegal = (word & (A | R | E)) == A && srcKind != -1 && dstKind != -1 ? True : False;
+
+    instruction->opcode = undecodedOpcode;
+    instruction->isResolved = 0;
+    if (!isLegal)
+        return False;
+
+    instruction->srcKind = (unsigned char)srcKind;
+    instruction->dstKind = (unsigned char)dstKind;
+    instruction->src = instruction->dst = 0;
+
+    /* Two register operands (direct or indirect) share a single word */
+    if ((srcKind == registerOperand || srcKind == indirectOperand) && (dstKind == registerOperand || dstKind == indirectOperand))
+    {
+        if (next >= RAM_MEMORY_SIZE)
+            return False;
+        isLegal = decodeOperandWord(machine->memory[next], &instruction->srcKind, 6, &instruction->src) &&
+                  decodeOperandWord(machine->memory[next], &instruction->dstKind, 3, &instruction->dst);
+        next++;
+    }
+    else
+    {
+        if (srcKind != noOperand)
+        {
+            if (next >= RAM_MEMORY_SIZE)
+                return False;
+            isLegal = decodeOperandWord(machine->memory[next++], &instruction->srcKind, 6, &instruction->src);
+        }
+        if (dstKind != noOperand)
+        {
+            if (next >= RAM_MEMORY_SIZE)
+                return False;
+            isLegal = decodeOperandWord(machine->memory[next++], &instruction->dstKind, 3, &instruction->dst) && isLegal;
+        }
+    }
+
+    if (!isLegal)
+        return False;
+
+    instruction->size = (unsigned char)(next - address);
+    instruction->opcode = (unsigned char)op->op;
+    instruction->isResolved = resolveOperandCell(machine, instruction->srcKind, &instruction->src, &instruction->srcCell) &&
+                                      resolveOperandCell(machine, instruction->dstKind, &instruction->dst, &instruction->dstCell)
+                                  ? 1
+                                  : 0;
+    return True;
+}
+
+/**
+ * decodeCode
+ * ----------
+ * Decodes every instruction of the loaded code, one after the other from MEMORY_START.
+ * The decoding stops at a word that is not a legal instruction, the program faults if it gets there.
+ *
+ * Parameters:
+ * - machine: The machine.
+ */
+static void decodeCode(Machine *machine)
+{
+    unsigned address;
+
+    for (address = 0; address < RAM_MEMORY_SIZE; address++)
+    {
+        machine->decoded[address].opcode = undecodedOpcode;
+        machine->decoded[address].isResolved = 0;
+    }
+
+    address = MEMORY_START;
+    while (address < machine->codeEnd && decodeInstruction(machine, address))
+        address += machine->decoded[address].size;
+}
+
+/**
+ * storeWord
+ * ---------
+ * Writes a word to a register or to the memory. A write to a word of a decoded instruction, in the code
+ * or in the data it was decoded from when it was reached, makes the instruction undecoded, so it is
+ * decoded again when it is reached.
+ * The pages of the memory words and decoded instructions that changed are marked dirty.
+ *
+ * Parameters:
+ * - machine: The machine.
+ * - cell: The register or the memory word.
+ * - value: The value to write.
+ */
+static void storeWord(Machine *machine, Word *cell, unsigned value)
+{
+    DecodedInstruction *decoded;
+    unsigned address, i;
+
+    *cell = (Word)(value & WORD_MASK);
+    if (cell < machine->memory || cell >= machine->memory + RAM_MEMORY_SIZE)
+        return;
+
+    address = (unsigned)(cell - machine->memory);
+    machine->dirtyPages[address / EMULATOR_PAGE_WORDS] = 1;
+    for (i = 0; i < 3 && i <= address; i++) /* An instruction is up to 3 words long */
+    {
+        decoded = &machine->decoded[address - i];
+        if (decoded->opcode != undecodedOpcode && decoded->size > i)
+        {
+            decoded->opcode = undecodedOpcode;
+            decoded->isResolved = 0;
+            machine->dirtyPages[(address - i) / EMULATOR_PAGE_WORDS] = 1; /* It may start on the previous page */
+        }
+    }
+}
+
+/**
+ * readInputCharacter
+ * ------------------
+ * Reads the next character of the input of the program for red, the standard input unless the machine was given its own.
+ *
+ * Returns:
+ * - unsigned: The character, or WORD_MASK (-1) at the end of the input.
+ */
+static unsigned readInputCharacter(Machine *machine)
+{
+    size_t count;
+
+    if (machine->input == NULL)
+    {
+        while (!isStandardInputRead && reserveOutputBuffer(&standardInput, BUFSIZ))
+        {
+            count = fread(standardInput.data + standardInput.length, 1, BUFSIZ, stdin);
+            standardInput.length += count;
+            if (count < BUFSIZ)
+                isStandardInputRead = True;
+        }
+        isStandardInputRead = True;
+        machine->input = standardInput.data;
+        machine->inputLength = standardInput.length;
+    }
+
+    if (machine->inputPosition >= machine->inputLength)
+        return WORD_MASK;
+    return (unsigned char)machine->input[machine->inputPosition++];
+}
+
+/**
+ * printValue
+ * ----------
+ * Appends the signed value of a word and a new line to the output of the program for prn.
+ * The output is written when it grows past EMULATOR_OUTPUT_FLUSH_SIZE.
+ */
+static void printValue(Machine *machine, Word word)
+{
+    int value = toSigned(word);
+    char *p;
+
+    if (!reserveOutputBuffer(&machine->output, MAX_DECIMAL_DIGITS + 2))
+        return;
+
+    p = machine->output.data + machine->output.length;
+    if (value < 0)
+        *p++ = '-';
+    p += formatDecimal(p, (unsigned)(value < 0 ? -value : value), 1);
+    *p++ = '\n';
+    machine->output.length = (size_t)(p - machine->output.data);
+
+    if (machine->outputFile != NULL && machine->output.length >= EMULATOR_OUTPUT_FLUSH_SIZE)
+        flushMachineOutput(machine);
+}
+
+/**
+ * initMachine
+ * -----------
+ * Clears a machine: its registers, program status word and memory. The stack is empty and
+ * the program may execute --max-steps instructions. The output is written to stdout.
+ *
+ * Parameters:
+ * - machine: The machine.
+ */
+void initMachine(Machine *machine)
+{
+    memset(machine->registers, 0, sizeof(machine->registers));
+    memset(machine->memory, 0, sizeof(machine->memory));
+    machine->psw = 0;
+    machine->pc = MEMORY_START;
+    machine->sp = RAM_MEMORY_SIZE;
+    machine->codeEnd = machine->imageEnd = MEMORY_START;
+    machine->steps = 0;
+    machine->maxSteps = getMaxSteps();
+    machine->status = machineStopped;
+    initOutputBuffer(&machine->output);
+    machine->outputFile = stdout;
+    machine->input = NULL;
+    machine->inputLength = machine->inputPosition = 0;
+    machine->profile = NULL;
+    memset(machine->dirtyPages, 0, sizeof(machine->dirtyPages));
+    machine->snapshot = NULL;
+}
+
+/**
+ * loadMemoryImage
+ * ---------------
+ * Loads the memory image of the assembled source file into a cleared machine, and decodes its code.
+ *
+ * Parameters:
+ * - machine: The machine.
+ *
+ * Returns:
+ * - Bool: True if the image was loaded, False if it does not fit in the memory of the machine.
+ */
+Bool loadMemoryImage(Machine *machine)
+{
+    if (getDCF() > RAM_MEMORY_SIZE)
+        return False;
+
+    machine->codeEnd = getICF();
+    machine->imageEnd = getDCF();
+    memcpy(machine->memory + MEMORY_START, getMemoryImage(), (machine->imageEnd - MEMORY_START) * sizeof(Word));
+    decodeCode(machine);
+    return True;
+}
+
+/**
+ * loadObFile
+ * ----------
+ * Loads a .ob file into a cleared machine, and decodes its code. The first line holds the sizes
+ * of the code and of the data, and each other line the address of a word and its five octal digits.
+ *
+ * Parameters:
+ * - machine: The machine.
+ * - fileName: The name of the .ob file.
+ *
+ * Returns:
+ * - Bool: True if the file was read, False if it could not be opened or is not a legal .ob file.
+ */
+Bool loadObFile(Machine *machine, char *fileName)
+{
+    FILE *file = fopen(fileName, "r");
+    char line[MAX_LINE_LEN];
+    unsigned codeSize, dataSize, address, word;
+    Bool isLegal;
+
+    if (file == NULL)
+        return False;
+
+    isLegal = fgets(line, MAX_LINE_LEN, file) != NULL && sscanf(line, "%u %u", &codeSize, &dataSize) == 2 &&
+                      MEMORY_START + codeSize + dataSize <= RAM_MEMORY_SIZE
+                  ? True
+                  : False;
+
+    if (isLegal)
+    {
+        machine->codeEnd = MEMORY_START + codeSize;
+        machine->imageEnd = machine->codeEnd + dataSize;
+        while (isLegal && fgets(line, MAX_LINE_LEN, file) != NULL)
+        {
+            if (sscanf(line, "%u %o", &address, &word) != 2 || address < MEMORY_START || address >= machine->imageEnd || word > WORD_MASK)
+                isLegal = False;
+            else
+                machine->memory[address] = (Word)word;
+        }
+    }
+
+    fclose(file);
+    if (isLegal)
+        decodeCode(machine);
+    return isLegal;
+}
+
+/**
+ * fetchInstruction
+ * ----------------
+ * Finds the instruction at the program counter and the registers or memory words of its operands,
+ * decoding the instruction first if its address is undecoded.
+ *
+ * Parameters:
+ * - machine: The machine.
+ * - pc: The program counter.
+ * - steps: The number of instructions the program executed.
+ * - instruction: Where the instruction is written.
+ * - source: Where the source operand is written.
+ * - target: Where the destination operand is written.
+ *
+ * Returns:
+ * - MachineStatus: machineRunning if the instruction can be executed, or the fault that stops the program.
+ */
+static MachineStatus fetchInstruction(Machine *machine, unsigned pc, unsigned long steps, DecodedInstruction **instruction, Word **source, Word **target)
+{
+    if (steps >= machine->maxSteps)
+        return stepLimitReached;
+    if (pc >= RAM_MEMORY_SIZE)
+        return addressOutOfMemory;
+
+    *instruction = &machine->decoded[pc];
+    if ((*instruction)->opcode == undecodedOpcode)
+    {
+        machine->dirtyPages[pc / EMULATOR_PAGE_WORDS] = 1;
+        if (!decodeInstruction(machine, pc))
+            return illegalInstruction;
+    }
+
+    *source = getOperandCell(machine, (*instruction)->srcKind, &(*instruction)->src);
+    *target = getOperandCell(machine, (*instruction)->dstKind, &(*instruction)->dst);
+    if ((*source == NULL && (*instruction)->srcKind != noOperand) || (*target == NULL && (*instruction)->dstKind != noOperand))
+        return (*instruction)->srcKind == externalOperand || (*instruction)->dstKind == externalOperand ? externalReference : addressOutOfMemory;
+
+    return machineRunning;
+}
+
+/*
+ * The emulation loop is written once for two dispatch methods, selected when the emulator is built:
+ * - Direct threading (by default with GCC): the address of the code of each operation is kept in a table
+ *   indexed by the opcode, and the code of each operation ends by fetching the next instruction and jumping
+ *   to the code of its operation, so each operation has its own (better predicted) indirect jump.
+ * - A switch over the opcode (with -DEMULATOR_SWITCH_DISPATCH, or with other compilers), that is standard C.
+ * OPERATION marks the code of an operation, and NEXT_OPERATION ends it.
+ */
+#if !defined(__GNUC__) && !defined(EMULATOR_SWITCH_DISPATCH)
+#define EMULATOR_SWITCH_DISPATCH
+#endif
+
+/* The common case (a decoded instruction whose operands are known) is handled in place, and fetchInstruction handles the rest */
+#define FETCH_INSTRUCTION()                                                                                         \
+    pc = next;                                                                                                      \
+    if (steps < maxSteps && pc < RAM_MEMORY_SIZE && (instruction = &machine->decoded[pc])->isResolved)              \
+    {                                                                                                               \
+        source = (Word *)machine + instruction->srcCell;                                                            \
+        target = (Word *)machine + instruction->dstCell;                                                            \
+    }                                                                                                               \
+    else if ((status = fetchInstruction(machine, pc, steps, &instruction, &source, &target)) != machineRunning)     \
+        goto halt;                                                                                                  \
+    if (profile != NULL)                                                                                            \
+    {                                                                                                               \
+        profile->executions[pc]++;                                                                                  \
+        profile->opcodes[instruction->opcode]++;                                                                    \
+    }                                                                                                               \
+    steps++;                                                                                                        \
+    next = pc + instruction->size
+
+/* A jump that is taken back to an address that is not after it ends an iteration of a loop */
+#define COUNT_BACK_JUMP()                     \
+    if (profile != NULL && next <= pc)        \
+        profile->backJumps[pc]++
+
+#ifdef EMULATOR_SWITCH_DISPATCH
+#define OPERATION(opcode) case opcode:
+#define NEXT_OPERATION continue
+#else
+#define OPERATION(opcode) opcode##Code:
+#define NEXT_OPERATION        \
+    FETCH_INSTRUCTION();      \
+    goto *operationsCode[instruction->opcode]
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpedantic" /* The labels as values are a GCC extension */
+#endif
+
+/**
+ * runMachine
+ * ----------
+ * Runs the loaded program from its program counter until it executes stop, faults, or executes
+ * the --max-steps instructions. Each instruction was decoded before, so its operands are found
+ * from the decoded kinds and values, and an undecoded address is decoded when it is reached.
+ * When the machine has a profile, the instructions and the loop iterations are counted in it.
+ *
+ * Parameters:
+ * - machine: The machine.
+ *
+ * Returns:
+ * - MachineStatus: The status the program ended with (also kept in the machine).
+ */
+MachineStatus runMachine(Machine *machine)
+{
+#ifndef EMULATOR_SWITCH_DISPATCH
+    static void *const operationsCode[OP_SIZE] = {
+        &&movOpcodeCode, &&cmpOpcodeCode, &&addOpcodeCode, &&subOpcodeCode, &&leaOpcodeCode, &&clrOpcodeCode,
+        &&notOpcodeCode, &&incOpcodeCode, &&decOpcodeCode, &&jmpOpcodeCode, &&bneOpcodeCode, &&redOpcodeCode,
+        &&prnOpcodeCode, &&jsrOpcodeCode, &&rtsOpcodeCode, &&stopOpcodeCode};
+#endif
+    Word *memory = machine->memory, *source = NULL, *target = NULL;
+    DecodedInstruction *instruction = NULL;
+    Profile *profile = machine->profile;
+    MachineStatus status;
+    unsigned pc = machine->pc, next = machine->pc;
+    unsigned long steps = machine->steps, maxSteps = machine->maxSteps;
+
+#ifdef EMULATOR_SWITCH_DISPATCH
+    for (;;)
+    {
+        FETCH_INSTRUCTION();
+        switch (instruction->opcode)
+        {
+#else
+    FETCH_INSTRUCTION();
+    goto *operationsCode[instruction->opcode];
+#endif
+        OPERATION(movOpcode)
+            storeWord(machine, target, *source);
+            NEXT_OPERATION;
+        OPERATION(cmpOpcode)
+            machine->psw = ((*source - *target) & WORD_MASK) == 0 ? PSW_ZERO : 0;
+            NEXT_OPERATION;
+        OPERATION(addOpcode)
+            storeWord(machine, target, *target + *source);
+            NEXT_OPERATION;
+        OPERATION(subOpcode)
+            storeWord(machine, target, *target - *source);
+            NEXT_OPERATION;
+        OPERATION(leaOpcode)
+            storeWord(machine, target, (unsigned)(source - memory));
+            NEXT_OPERATION;
+        OPERATION(clrOpcode)
+            storeWord(machine, target, 0);
+            NEXT_OPERATION;
+        OPERATION(notOpcode)
+            storeWord(machine, target, ~(unsigned)*target);
+            NEXT_OPERATION;
+        OPERATION(incOpcode)
+            storeWord(machine, target, *target + 1u);
+            NEXT_OPERATION;
+        OPERATION(decOpcode)
+            storeWord(machine, target, *target - 1u);
+            NEXT_OPERATION;
+        OPERATION(jmpOpcode)
+            next = (unsigned)(target - memory);
+            COUNT_BACK_JUMP();
+            NEXT_OPERATION;
+        OPERATION(bneOpcode)
+            if (!(machine->psw & PSW_ZERO))
+            {
+                next = (unsigned)(target - memory);
+                COUNT_BACK_JUMP();
+            }
+            NEXT_OPERATION;
+        OPERATION(redOpcode)
+            storeWord(machine, target, readInputCharacter(machine));
+            NEXT_OPERATION;
+        OPERATION(prnOpcode)
+            printValue(machine, *target);
+            NEXT_OPERATION;
+        OPERATION(jsrOpcode)
+            if (machine->sp <= machine->imageEnd)
+            {
+                status = stackOverflow;
+                goto halt;
+            }
+            memory[--machine->sp] = (Word)next;
+            machine->dirtyPages[machine->sp / EMULATOR_PAGE_WORDS] = 1;
+            next = (unsigned)(target - memory);
+            NEXT_OPERATION;
+        OPERATION(rtsOpcode)
+            if (machine->sp >= RAM_MEMORY_SIZE)
+            {
+                status = stackUnderflow;
+                goto halt;
+            }
+            next = memory[machine->sp++];
+            NEXT_OPERATION;
+        OPERATION(stopOpcode)
+            status = machineStopped;
+            goto halt;
+#ifdef EMULATOR_SWITCH_DISPATCH
+        }
+    }
+#endif
+
+halt:
+    machine->pc = pc;
+    machine->steps = steps;
+    machine->status = status;
+    return status;
+}
+
+#ifndef EMULATOR_SWITCH_DISPATCH
+#pragma GCC diagnostic pop
+#endif
+
+/**
+ * getMachineStatusMessage
+ * -----------------------
+ * Returns the text of the status a program ended with.
+ *
+ * Parameters:
+ * - status: The status.
+ *
+ * Returns:
+ * - char*: The text, e.g. "illegal instruction".
+ */
+char *getMachineStatusMessage(MachineStatus status)
+{
+    return statusMessages[status];
+}
+
+/**
+ * flushMachineOutput
+ * ------------------
+ * Writes the output the program printed so far to the output file of the machine, and clears it.
+ *
+ * Parameters:
+ * - machine: The machine.
+ */
+void flushMachineOutput(Machine *machine)
+{
+    if (machine->outputFile != NULL && machine->output.length > 0)
+        fwrite(machine->output.data, 1, machine->output.length, machine->outputFile);
+    machine->output.length = 0;
+}
+
+/**
+ * freeMachine
+ * -----------
+ * Frees the output buffer of a machine.
+ *
+ * Parameters:
+ * - machine: The machine.
+ */
+void freeMachine(Machine *machine)
+{
+    freeOutputBuffer(&machine->output);
+}
+
+/**
+ * snapshotMachine
+ * ---------------
+ * Copies the full state of a machine to a snapshot: its registers, program status word, memory and
+ * decoded instructions, its input position and its output. The pages of the machine are clean after it,
+ * so restoring the machine from this snapshot copies only the pages that are written from now on.
+ *
+ * Parameters:
+ * - machine: The machine.
+ * - snapshot: The snapshot, that is overwritten (a snapshot that was taken before must be freed first).
+ *
+ * Returns:
+ * - Bool: False if the memory for the copy of the output could not be allocated.
+ */
+Bool snapshotMachine(Machine *machine, MachineSnapshot *snapshot)
+{
+    snapshot->state = *machine;
+    initOutputBuffer(&snapshot->state.output);
+    if (machine->output.length > 0)
+    {
+        if (!reserveOutputBuffer(&snapshot->state.output, machine->output.length))
+            return False;
+        memcpy(snapshot->state.output.data, machine->output.data, machine->output.length);
+        snapshot->state.output.length = machine->output.length;
+    }
+
+    memset(machine->dirtyPages, 0, sizeof(machine->dirtyPages));
+    machine->snapshot = snapshot;
+    return True;
+}
+
+/**
+ * restoreMachine
+ * --------------
+ * Brings a machine back to the state of a snapshot, without loading its program again. When the machine
+ * was snapshotted to, or last restored from, the same snapshot, only its dirty pages are copied, so the
+ * restore costs as much as the memory the program wrote to. Otherwise all the pages are copied.
+ * The output file and the profile of the machine are kept, they are not a part of the state of the program.
+ *
+ * Parameters:
+ * - machine: The machine.
+ * - snapshot: The snapshot.
+ */
+void restoreMachine(Machine *machine, const MachineSnapshot *snapshot)
+{
+    const Machine *state = &snapshot->state;
+    Bool isFullCopy = machine->snapshot != snapshot ? True : False;
+    unsigned page, start;
+
+    memcpy(machine->registers, state->registers, sizeof(machine->registers));
+    machine->psw = state->psw;
+    machine->pc = state->pc;
+    machine->sp = state->sp;
+    machine->codeEnd = state->codeEnd;
+    machine->imageEnd = state->imageEnd;
+    machine->steps = state->steps;
+    machine->maxSteps = state->maxSteps;
+    machine->status = state->status;
+    machine->input = state->input;
+    machine->inputLength = state->inputLength;
+    machine->inputPosition = state->inputPosition;
+
+    for (page = 0; page < EMULATOR_PAGES_COUNT; page++)
+        if (isFullCopy || machine->dirtyPages[page])
+        {
+            start = page * EMULATOR_PAGE_WORDS;
+            memcpy(machine->memory + start, state->memory + start, EMULATOR_PAGE_WORDS * sizeof(Word));
+            memcpy(machine->decoded + start, state->decoded + start, EMULATOR_PAGE_WORDS * sizeof(DecodedInstruction));
+            machine->dirtyPages[page] = 0;
+        }
+
+    machine->output.length = 0;
+    if (state->output.length > 0 && reserveOutputBuffer(&machine->output, state->output.length))
+    {
+        memcpy(machine->output.data, state->output.data, state->output.length);
+        machine->output.length = state->output.length;
+    }
+    machine->snapshot = snapshot;
+}
+
+/**
+ * freeMachineSnapshot
+ * -------------------
+ * Frees the copy of the output that a snapshot holds.
+ *
+ * Parameters:
+ * - snapshot: The snapshot.
+ */
+void freeMachineSnapshot(MachineSnapshot *snapshot)
+{
+    freeOutputBuffer(&snapshot->state.output);
+}
+
+/**
+ * reportProgramEnd
+ * ----------------
+ * Reports how a program ended, after its output was written: an error on stderr if it faulted,
+ * and a summary line (unless --verbosity=quiet) with the number of instructions it executed.
+ *
+ * Parameters:
+ * - name: The name of the program in the reports.
+ * - status: The status the program ended with.
+ * - pc: The address the program stopped at.
+ * - steps: The number of instructions the program executed.
+ */
+void reportProgramEnd(char *name, MachineStatus status, unsigned pc, unsigned long steps)
+{
+    fflush(stdout);
+    if (status != machineStopped)
+    {
+        fprintf(stderr, "\n%s\n", DIAGNOSTICS_SEPARATOR);
+        fprintf(stderr, " ERROR: %s stopped at address %u: %s\n", name, pc, getMachineStatusMessage(status));
+        fprintf(stderr, "%s\n\n", DIAGNOSTICS_SEPARATOR);
+    }
+    if (isVerbose(normalVerbosity))
+        printf("%s: ran %lu instructions\n", name, steps);
+}
+
+/**
+ * reportRun
+ * ---------
+ * Runs a loaded program, writes its output to stdout and reports how it ended (reportProgramEnd).
+ * With --stats, the processor time of the run and the instructions per second are printed too,
+ * and with --profile, the program is profiled and its profile is printed after it ended.
+ *
+ * Parameters:
+ * - machine: The machine, with the program loaded.
+ * - name: The name of the program in the reports.
+ * - hasSourceLines: True if the program is the source file that was just assembled, so its addresses have source lines.
+ */
+static void reportRun(Machine *machine, char *name, Bool hasSourceLines)
+{
+    clock_t start;
+    MachineStatus status;
+    double seconds;
+
+    if (isProfileEnabled() && (machine->profile = (Profile *)calloc(1, sizeof(Profile))) == NULL)
+        reportError(memoryAllocationFailure); /* The program still runs, without a profile */
+
+    start = clock();
+    status = runMachine(machine);
+    seconds = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+    flushMachineOutput(machine);
+    reportProgramEnd(name, status, machine->pc, machine->steps);
+    if (isStatsEnabled())
+        printf("  emulation: %lu instructions in %.3f ms, %.0f instructions/s\n", machine->steps, seconds * 1000,
+               seconds > 0 ? machine->steps / seconds : 0);
+    if (machine->profile != NULL)
+    {
+        printProfile(machine, name, hasSourceLines);
+        free(machine->profile);
+        machine->profile = NULL;
+    }
+}
+
+/**
+ * runObFile
+ * ---------
+ * Loads a .ob file and runs it, reporting how the program ended.
+ *
+ * Parameters:
+ * - fileName: The name of the .ob file.
+ */
+void runObFile(char *fileName)
+{
+    Machine *machine = (Machine *)malloc(sizeof(Machine));
+
+    if (machine == NULL)
+    {
+        reportError(memoryAllocationFailure);
+        return;
+    }
+
+    initMachine(machine);
+    if (loadObFile(machine, fileName))
+        reportRun(machine, fileName, False);
+    else
+    {
+        fprintf(stderr, "\n%s\n", DIAGNOSTICS_SEPARATOR);
+        fprintf(stderr, " ERROR: Could not load object file %s\n", fileName);
+        fprintf(stderr, "%s\n\n", DIAGNOSTICS_SEPARATOR);
+    }
+
+    freeMachine(machine);
+    free(machine);
+}
+
+/**
+ * runAssembledImage
+ * -----------------
+ * Runs the memory image of the source file that was just assembled, reporting how the program ended.
+ *
+ * Parameters:
+ * - fileName: The base name of the source file, the program is named by its .ob file in the reports.
+ */
+void runAssembledImage(char *fileName)
+{
+    Machine *machine = (Machine *)malloc(sizeof(Machine));
+    char *name = (char *)malloc(strlen(fileName) + sizeof(OB_EXTENSION));
+
+    if (machine == NULL || name == NULL)
+        reportError(memoryAllocationFailure);
+    else
+    {
+        strcpy(name, fileName);
+        strcat(name, OB_EXTENSION);
+        initMachine(machine);
+        if (loadMemoryImage(machine))
+            reportRun(machine, name, True);
+        else
+        {
+            fprintf(stderr, "\n%s\n", DIAGNOSTICS_SEPARATOR);
+            fprintf(stderr, " ERROR: Could not load %s, its image is larger than the memory\n", name);
+            fprintf(stderr, "%s\n\n", DIAGNOSTICS_SEPARATOR);
+        }
+        freeMachine(machine);
+    }
+
+    free(machine);
+    free(name);
+}
+
+/**
+ * freeEmulatorInput
+ * -----------------
+ * Frees the standard input that was read for the red instructions, at the end of the run.
+ */
+void freeEmulatorInput()
+{
+    freeOutputBuffer(&standardInput);
+    isStandardInputRead = False;
+}
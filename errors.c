@@ -1,774 +1,581 @@
 #include "data.h"
 
-/* Dynamic array of LogFiles (list of fileName entries) */
-static LogFiles *logFiles = NULL;
-static int logFilesCount = 0;
+#define STRINGIFY(x) #x
+#define TO_STRING(x) STRINGIFY(x)
+/* A catalog entry, with the name of the Error or Warning value as it is written in the JSON diagnostics */
+#define CATALOG_ENTRY(code, severity, message) {code, #code, severity, message}
+
+/**
+ * The message catalog: the name and text of every error, warning and failure the assembler reports.
+ * All the sinks (stderr, the log files and the JSON diagnostics) render diagnostics from this single table.
+ */
+static DiagnosticMessage messages[] = {
+    CATALOG_ENTRY(macroDeclaretionWithoutDefiningMacroName, errorDiagnostic, "Macro declaration without defining macro name!"),
+    CATALOG_ENTRY(illegalInputPassedAsOperandSrcOperand, errorDiagnostic, "illegal operands input passed to source operand "),
+    CATALOG_ENTRY(illegalInputPassedAsOperandDesOperand, errorDiagnostic, "illegal operands input passed to destination operand "),
+    CATALOG_ENTRY(desOperandTypeIsNotAllowed, errorDiagnostic, "type of destination operand passed to operation is not accepted!"),
+    CATALOG_ENTRY(srcOperandTypeIsNotAllowed, errorDiagnostic, "type of source operand passed to operation is not accepted!"),
+    CATALOG_ENTRY(undefinedLabelDeclaretion, errorDiagnostic, "undefined Label Declaretion"),
+    CATALOG_ENTRY(emptyLabelDecleration, errorDiagnostic, "empty Label Declaretion"),
+    CATALOG_ENTRY(emptyStringDeclatretion, errorDiagnostic, "empty String Declatretion"),
+    CATALOG_ENTRY(missingSpaceBetweenLabelDeclaretionAndInstruction, errorDiagnostic, "Missing space between label declaretion and instruction name"),
+    CATALOG_ENTRY(illegalLabelNameLength, errorDiagnostic, "illegal Label Name length is greater than the maximum allowed which is " TO_STRING(MAX_LABEL_LEN) " characters"),
+    CATALOG_ENTRY(extraOperandsPassed, errorDiagnostic, "Extra operands passed as paramters"),
+    CATALOG_ENTRY(wrongCommasSyntaxIllegalApearenceOfCommasInLine, errorDiagnostic, "Illegal apearence of commas in line"),
+    CATALOG_ENTRY(wrongCommasSyntaxExtra, errorDiagnostic, "Extra commas between arguments"),
+    CATALOG_ENTRY(wrongCommasSyntaxMissing, errorDiagnostic, "Missing Commas between arguments"),
+    CATALOG_ENTRY(illegalLabelNameUseOfSavedKeywordUsingOperationName, errorDiagnostic, "illegal Label Name Use Of Saved Keyword.\nUsing Operation Name is not allowed"),
+    CATALOG_ENTRY(illegalLabelNameUseOfSavedKeywordUsingRegisteryName, errorDiagnostic, "illegal Label Name Use Of Saved Keyword.\nUsing Registery Name is not allowed"),
+    CATALOG_ENTRY(illegalLabelNameUseOfSavedKeywords, errorDiagnostic, "illegal Label Name Use Of Saved Keyword.\n"),
+    CATALOG_ENTRY(illegalOverrideOfLocalSymbolWithExternalSymbol, errorDiagnostic, "symbol already declared and defined locally,\nso it could not be re-declared as external variable."),
+    CATALOG_ENTRY(illegalApearenceOfCharactersInTheEndOfTheLine, errorDiagnostic, "illegal apearence of extra characters in the end of the line"),
+    CATALOG_ENTRY(afterPlusOrMinusSignThereMustBeANumber, errorDiagnostic, "after Plus Or Minus Sign There Must Be A Number without any spaces between"),
+    CATALOG_ENTRY(useOfNestedMacrosIsIllegal, errorDiagnostic, "useOfNestedMacrosIsIllegal"),
+    CATALOG_ENTRY(macroClosingWithoutAnyOpenedMacro, errorDiagnostic, "macroClosingWithoutAnyOpenedMacro"),
+    CATALOG_ENTRY(illegalMacroParameterName, errorDiagnostic, "illegal Macro Parameter Name"),
+    CATALOG_ENTRY(macroArgumentsCountMismatch, errorDiagnostic, "number of arguments passed to macro does not match its parameters"),
+    CATALOG_ENTRY(macroRecursiveUse, errorDiagnostic, "macro uses itself"),
+    CATALOG_ENTRY(expandedLineTooLong, errorDiagnostic, "a line of the macro expansion is longer than the maximum line length"),
+    CATALOG_ENTRY(imageExceedsMemorySize, errorDiagnostic, "the code and data of the program do not fit in the memory of the machine"),
+    CATALOG_ENTRY(missinSpaceAfterInstruction, errorDiagnostic, "missin Space between instruction and arguments"),
+    CATALOG_ENTRY(illegalApearenceOfCommaBeforeFirstParameter, errorDiagnostic, "Illegal appearence of a comma before the first parameter"),
+    CATALOG_ENTRY(illegalApearenceOfCommaAfterLastParameter, errorDiagnostic, "Illegal appearence of a comma after the last parameter"),
+    CATALOG_ENTRY(wrongInstructionSyntaxIllegalCommaPosition, errorDiagnostic, "comma appearence on line is illegal!"),
+    CATALOG_ENTRY(labelNotExist, errorDiagnostic, "undefined label name, label name was not found in symbol table, assembler compilation faild, not files were created"),
+    CATALOG_ENTRY(operandTypeDoNotMatch, errorDiagnostic, "Operand type does not fit to current operation"),
+    CATALOG_ENTRY(entryDeclaredButNotDefined, errorDiagnostic, "operand is registered as .entry in table but is not defined in the file"),
+    CATALOG_ENTRY(requiredSourceOperandIsMissin, errorDiagnostic, "required source operand is missing"),
+    CATALOG_ENTRY(requiredDestinationOperandIsMissin, errorDiagnostic, "required destination operand is missing"),
+    CATALOG_ENTRY(illegalMacroNameUseOfSavedKeywords, errorDiagnostic, "illegal Macro Name Use Of Saved Keywords"),
+    CATALOG_ENTRY(wrongRegisteryReferenceUndefinedReg, errorDiagnostic, "undefined registery, registeries names are r0 - r7"),
+    CATALOG_ENTRY(fileCouldNotBeOpened, errorDiagnostic, "file could not be  opened"),
+    CATALOG_ENTRY(illegalOverrideOfExternalSymbol, errorDiagnostic, "Overriding of external symbol exisiting in table is not allowed!"),
+    CATALOG_ENTRY(memoryAllocationFailure, errorDiagnostic, "memory allocation failed"),
+    CATALOG_ENTRY(undefinedOperation, errorDiagnostic, "undefined operation name"),
+    CATALOG_ENTRY(undefinedInstruction, errorDiagnostic, "undefined instruction name"),
+    CATALOG_ENTRY(tooMuchArgumentsPassed, errorDiagnostic, "too Much Arguments Passed"),
+    CATALOG_ENTRY(notEnoughArgumentsPassed, errorDiagnostic, "too little arguments passed"),
+    CATALOG_ENTRY(symbolDoesNotExist, errorDiagnostic, "symbol does not exist"),
+    CATALOG_ENTRY(macroDoesNotExist, errorDiagnostic, "macro does not exist"),
+    CATALOG_ENTRY(wrongArgumentTypePassedAsParam, errorDiagnostic, "wrong Argument Type Passed As Param"),
+    CATALOG_ENTRY(illegalMacroNameUseOfCharacters, errorDiagnostic, "illegal Macro Name Use Of Characters"),
+    CATALOG_ENTRY(illegalLabelNameUseOfCharacters, errorDiagnostic, "illegal Label Name Use Of Characters"),
+    CATALOG_ENTRY(illegalLabelDeclaration, errorDiagnostic, "illegal Label Declaration"),
+    CATALOG_ENTRY(illegalMacroNameLength, errorDiagnostic, "illegal Macro Name Length"),
+    CATALOG_ENTRY(illegalSymbolNameAlreadyInUse, errorDiagnostic, "Label Name Already In Use"),
+    CATALOG_ENTRY(illegalMacroNameAlreadyInUse, errorDiagnostic, "Macro Name Already In Use"),
+    CATALOG_ENTRY(wrongArgumentTypeNotAnInteger, errorDiagnostic, "Number must be an integer!"),
+    CATALOG_ENTRY(expectedNumber, errorDiagnostic, "expected number but got letter instead, argument must be an integer number"),
+    CATALOG_ENTRY(symbolCannotBeBothCurrentTypeAndRequestedType, errorDiagnostic, "symbol Cannot Be Both Current Type And Requested Type"),
+    CATALOG_ENTRY(illegalLabelUseExpectedOperationOrInstruction, errorDiagnostic, "illegal Label Use Expected Operation Or Instruction"),
+    CATALOG_ENTRY(wrongInstructionSyntaxMissinCommas, errorDiagnostic, "Missing Comma between argumentes"),
+    CATALOG_ENTRY(wrongOperationSyntaxMissingCommas, errorDiagnostic, "Missing Comma between operands"),
+    CATALOG_ENTRY(wrongOperationSyntaxExtraCommas, errorDiagnostic, "Extra Comma between operands"),
+    CATALOG_ENTRY(wrongInstructionSyntaxExtraCommas, errorDiagnostic, "extra comma between arguments"),
+    CATALOG_ENTRY(expectedSingleCommaCharacter, errorDiagnostic, "Missing Comma"),
+    CATALOG_ENTRY(illegalApearenceOfCharactersOnLine, errorDiagnostic, "Illegal use of characters"),
+    CATALOG_ENTRY(undefinedTokenNotOperationOrInstructionOrLabel, errorDiagnostic, "illegal token in beginning of current line,  not operation nor instruction or label decleration"),
+    CATALOG_ENTRY(illegalApearenceOfExtraCharactersOnLine, errorDiagnostic, "Illegal appearence of extra characters after the end or before begning of the line"),
+    CATALOG_ENTRY(illegalApearenceOfCharacterInTheBegningOfTheLine, errorDiagnostic, "Illegal appearence of characters at beginning of the line"),
+    CATALOG_ENTRY(expectedQuotes, errorDiagnostic, "expected opening quotes before string"),
+    CATALOG_ENTRY(closingQuotesForStringIsMissing, errorDiagnostic, "missin closing quotes of string variable"),
+    CATALOG_ENTRY(maxLineLengthExceeded, errorDiagnostic, "line character length is illegal"),
+    CATALOG_ENTRY(labelNameAlreadyInUseInsideSymbolTable, errorDiagnostic, ""),
+    CATALOG_ENTRY(wrongInstructionSyntaxMissinQuotes, errorDiagnostic, ""),
+    CATALOG_ENTRY(none, errorDiagnostic, ""),
+    CATALOG_ENTRY(noErrors, errorDiagnostic, ""),
+    CATALOG_ENTRY(expectedBlank, errorDiagnostic, ""),
+    CATALOG_ENTRY(AssemblerDidNotGetSourceFiles, errorDiagnostic, ""),
+    CATALOG_ENTRY(secondRunFailed, errorDiagnostic, ""),
+    CATALOG_ENTRY(registeryIndexOperandTypeIfOutOfAllowedRegisteriesRange, errorDiagnostic, ""),
+    CATALOG_ENTRY(emptyDataDeclaretion, warningDiagnostic, "empty Data Declaretion"),
+    CATALOG_ENTRY(emptyExternalDeclaretion, warningDiagnostic, "empty external Declatretion"),
+    CATALOG_ENTRY(emptyEntryDeclaretion, warningDiagnostic, "empty entry Declatretion"),
+    CATALOG_ENTRY(emptyDeclaretionOfEntryOrExternalVariables, warningDiagnostic, "empty Declaretion Of Entry Or External Variables"),
+    CATALOG_ENTRY(instructionHasNoArguments, warningDiagnostic, "instruction Has No Arguments"),
+    CATALOG_ENTRY(fileCouldNotBeCreated, failureDiagnostic, "failed to create"),
+    CATALOG_ENTRY(fileCouldNotBeOpened, failureDiagnostic, "failed to open"),
+};
+
+/**
+ * The diagnostics of the current source file, kept until the file is done and flushed together.
+ * diagnosticFiles holds the names of the files the diagnostics belong to, each name is kept once
+ * and the diagnostics refer to it by its index (fileId).
+ */
+static Diagnostic *diagnostics = NULL;
+static int diagnosticsCount = 0, diagnosticsCapacity = 0;
+static char **diagnosticFiles = NULL;
+static int diagnosticFilesCount = 0, diagnosticFilesCapacity = 0;
+
+/**
+ * The number of errors reported for the current source file, and the number of errors that were
+ * not recorded since the --max-errors limit was reached.
+ */
+static int errorsCount = 0, suppressedErrorsCount = 0;
 
 static int (*line)() = &getCurrentLineNumber;
-static char *(*filePath)() = &getFileNamePath;
-static FILE *warningsFile = NULL, *errorsFile = NULL;
-static Bool isWarningFileExist = False;
-static Bool isErrorFileExist = False;
-
-/* Function to find or create log files for the given fileName */
-LogFiles *getLogFiles(char *fileName)
+static char *(*filePath)() = &peekFileNamePath;
+
+/**
+ * getDiagnosticMessage
+ * --------------------
+ * Finds the catalog entry, and the catalog text, of a diagnostic.
+ *
+ * Parameters:
+ * - code: The Error or Warning code of the diagnostic.
+ * - severity: The kind of the diagnostic.
+ *
+ * Returns:
+ * - char*: The message text, or an empty string if the code has no message.
+ */
+static DiagnosticMessage *findDiagnosticMessage(int code, DiagnosticSeverity severity)
 {
-    int i = 0;
-    LogFiles *newLogFile;
-    /* Check if the fileName already exists in the logFiles array */
-    for (i = 0; i < logFilesCount; i++)
-    {
-        if (strcmp(logFiles[i].fileName, fileName) == 0)
-        {
-            return &logFiles[i]; /* Return existing log file pointers */
-        }
-    }
-
-    /* If not found, allocate space for a new log file entry */
-    logFiles = realloc(logFiles, (logFilesCount + 1) * sizeof(LogFiles));
-    newLogFile = &logFiles[logFilesCount];
-    logFilesCount++;
-
-    /* Initialize the new log file entry */
-    strncpy(newLogFile->fileName, fileName, MAX_FILENAME_LEN);
-    newLogFile->warningsFile = NULL;
-    newLogFile->errorsFile = NULL;
-
-    return newLogFile;
+    int i;
+    for (i = 0; i < (int)(sizeof(messages) / sizeof(messages[0])); i++)
+        if (messages[i].code == code && messages[i].severity == severity)
+            return &messages[i];
+    return NULL;
 }
 
-/* Function to open the errors log file */
-void openErrorLogFile(LogFiles *logFile)
+char *getDiagnosticMessage(int code, DiagnosticSeverity severity)
 {
-    if (logFile->errorsFile == NULL)
-    {
-        char errorLogFileName[MAX_FILENAME_LEN];
-        snprintf(errorLogFileName, MAX_FILENAME_LEN, "%s.errors.log", logFile->fileName);
-        logFile->errorsFile = fopen(errorLogFileName, "w+");
-        if (logFile->errorsFile == NULL)
-        {
-            fprintf(stderr, "ERROR: Failed to create %s\n", errorLogFileName);
-        }
-    }
+    DiagnosticMessage *entry = findDiagnosticMessage(code, severity);
+    return entry != NULL ? entry->message : "";
 }
 
-/* Function to open the warnings log file */
-void openWarningLogFile(LogFiles *logFile)
+/**
+ * getDiagnosticName
+ * -----------------
+ * Finds the name of the code of a diagnostic in its enum.
+ *
+ * Parameters:
+ * - code: The Error or Warning code of the diagnostic.
+ * - severity: The kind of the diagnostic.
+ *
+ * Returns:
+ * - char*: The name of the code, or "unknown" if it is not in the catalog.
+ */
+char *getDiagnosticName(int code, DiagnosticSeverity severity)
 {
-    if (logFile->warningsFile == NULL)
-    {
-        char warningLogFileName[MAX_FILENAME_LEN];
-        snprintf(warningLogFileName, MAX_FILENAME_LEN, "%s.warnings.log", logFile->fileName);
-        logFile->warningsFile = fopen(warningLogFileName, "w+");
-        if (logFile->warningsFile == NULL)
-        {
-            fprintf(stderr, "ERROR: Failed to create %s\n", warningLogFileName);
-        }
-    }
+    DiagnosticMessage *entry = findDiagnosticMessage(code, severity);
+    return entry != NULL ? entry->name : "unknown";
 }
 
-void fileCreationFailure(char *fileName)
+/**
+ * getDiagnosticFileId
+ * -------------------
+ * Returns the index of a file name in the diagnostic files, adding it if it is not there yet.
+ * The name of the last added diagnostic is checked first, since consecutive diagnostics are
+ * almost always of the same file.
+ *
+ * Parameters:
+ * - fileName: The name of the file.
+ *
+ * Returns:
+ * - int: The index of the file name, or -1 if the memory could not be allocated.
+ */
+static int getDiagnosticFileId(char *fileName)
 {
-    extern FILE *errorsFile;
-    extern Bool isErrorFileExist;
+    int i;
+    char **files;
 
-    LogFiles *logFile = getLogFiles(fileName);
-    openErrorLogFile(logFile);
+    if (diagnosticsCount > 0 && !strcmp(diagnosticFiles[diagnostics[diagnosticsCount - 1].fileId], fileName))
+        return diagnostics[diagnosticsCount - 1].fileId;
 
-    if (!isErrorFileExist)
+    for (i = 0; i < diagnosticFilesCount; i++)
+        if (!strcmp(diagnosticFiles[i], fileName))
+            return i;
+
+    if (diagnosticFilesCount == diagnosticFilesCapacity)
     {
-        if ((errorsFile = logFile->errorsFile) == NULL)
-        {
-            fprintf(stderr, "\n######################################################################\n");
-            fprintf(stderr, " FAILURE! failed to create %s error log file\n", fileName);
-            fprintf(stderr, "######################################################################\n\n");
-        }
-        else
-            isErrorFileExist = True;
+        int newCapacity = diagnosticFilesCapacity ? diagnosticFilesCapacity * 2 : DIAGNOSTICS_INITIAL_SIZE;
+        if ((files = (char **)realloc(diagnosticFiles, newCapacity * sizeof(char *))) == NULL)
+            return -1;
+        diagnosticFiles = files;
+        diagnosticFilesCapacity = newCapacity;
     }
 
-    fprintf(stderr, "\n######################################################################\n");
-    fprintf(stderr, " FAILURE! failed to create %s file\n", fileName);
-    fprintf(stderr, "######################################################################\n\n");
-
-    fprintf(errorsFile, "\n######################################################################\n");
-    fprintf(errorsFile, " FAILURE! failed to create %s file\n", fileName);
-    fprintf(errorsFile, "######################################################################\n\n");
+    if ((diagnosticFiles[diagnosticFilesCount] = (char *)malloc(strlen(fileName) + 1)) == NULL)
+        return -1;
+    strcpy(diagnosticFiles[diagnosticFilesCount], fileName);
+    return diagnosticFilesCount++;
 }
 
-void fileOpeningFailure(char *fileName)
+/**
+ * getDiagnosticTextMaxLength
+ * --------------------------
+ * Returns the maximal number of characters the rendered text of a diagnostic can take.
+ */
+static size_t getDiagnosticTextMaxLength(Diagnostic *diagnostic)
 {
-    extern FILE *errorsFile;
-    extern Bool isErrorFileExist;
+    return strlen(diagnosticFiles[diagnostic->fileId]) * 2 + strlen(getDiagnosticMessage(diagnostic->code, diagnostic->severity)) +
+           DIAGNOSTIC_TEXT_MAX_EXTRA_LEN;
+}
 
-    LogFiles *logFile = getLogFiles(fileName);
-    openErrorLogFile(logFile);
+/**
+ * renderDiagnostic
+ * ----------------
+ * Writes the text of a diagnostic, as it appears on stderr and in the log files.
+ *
+ * Parameters:
+ * - diagnostic: The diagnostic.
+ * - dst: The destination, with room for getDiagnosticTextMaxLength characters.
+ *
+ * Returns:
+ * - size_t: The number of characters written.
+ */
+static size_t renderDiagnostic(Diagnostic *diagnostic, char *dst)
+{
+    char *fileName = diagnosticFiles[diagnostic->fileId];
+    char *message = getDiagnosticMessage(diagnostic->code, diagnostic->severity);
 
-    if (!isErrorFileExist)
+    switch (diagnostic->severity)
     {
-        if ((errorsFile = logFile->errorsFile) == NULL)
-        {
-            fprintf(stderr, "\n######################################################################\n");
-            fprintf(stderr, " FAILURE! failed to create %s error log file\n", fileName);
-            fprintf(stderr, "######################################################################\n\n");
-        }
-        else
-            isErrorFileExist = True;
+    case warningDiagnostic:
+        return sprintf(dst, "\n%s\nWarning!! in %s on line number %d\n%s\n%s\n\n", DIAGNOSTICS_SEPARATOR, fileName, diagnostic->line, message, DIAGNOSTICS_SEPARATOR);
+    case failureDiagnostic:
+        return sprintf(dst, "\n%s\n FAILURE! %s %s file\n%s\n\n", DIAGNOSTICS_SEPARATOR, message, diagnosticFiles[diagnostic->argId], DIAGNOSTICS_SEPARATOR);
+    default:
+        return sprintf(dst, "\n%s\nError!! occured in %s on line number %d\n%s\n%s\n", DIAGNOSTICS_SEPARATOR, fileName, diagnostic->line, message, DIAGNOSTICS_SEPARATOR);
     }
-
-    fprintf(stderr, "\n######################################################################\n");
-    fprintf(stderr, " FAILURE! failed to open %s file\n", fileName);
-    fprintf(stderr, "######################################################################\n\n");
-
-    fprintf(errorsFile, "\n######################################################################\n");
-    fprintf(errorsFile, " FAILURE! failed to open %s file\n", fileName);
-    fprintf(errorsFile, "######################################################################\n\n");
 }
 
-void reportWarningIntoFile(Warning err, char *fileName)
+/**
+ * getDiagnosticJsonMaxLength
+ * --------------------------
+ * Returns the maximal number of characters the JSON line of a diagnostic can take.
+ */
+static size_t getDiagnosticJsonMaxLength(Diagnostic *diagnostic)
 {
-    extern Bool isWarningFileExist;
-    extern FILE *warningsFile;
+    return (strlen(diagnosticFiles[diagnostic->fileId]) + strlen(getDiagnosticMessage(diagnostic->code, diagnostic->severity)) +
+            strlen(getDiagnosticName(diagnostic->code, diagnostic->severity)) + MAX_FILENAME_LEN * 2) *
+               JSON_ESCAPE_MAX_LEN +
+           JSON_DIAGNOSTIC_MAX_EXTRA_LEN;
+}
 
-    LogFiles *logFile = getLogFiles(fileName);
-    openWarningLogFile(logFile);
-    warningsFile = logFile->warningsFile;
+/**
+ * renderDiagnosticJson
+ * --------------------
+ * Writes a diagnostic as a single line JSON object, with its file, line, code name, severity and message.
+ *
+ * Parameters:
+ * - diagnostic: The diagnostic.
+ * - dst: The destination, with room for getDiagnosticJsonMaxLength characters.
+ *
+ * Returns:
+ * - size_t: The number of characters written.
+ */
+static size_t renderDiagnosticJson(Diagnostic *diagnostic, char *dst)
+{
+    static char *severities[] = {"error", "warning", "failure"};
+    char message[MAX_FILENAME_LEN * 2], *p = dst;
 
-    if (!isWarningFileExist)
-    {
-        if (warningsFile == NULL)
-            printf("Failed to open warning log file\n");
-        else
-            isWarningFileExist = True;
-    }
+    p += sprintf(p, "{\"file\":");
+    p += renderJsonString(p, diagnosticFiles[diagnostic->fileId]);
+    p += sprintf(p, ",\"line\":%d,\"code\":", diagnostic->line);
+    p += renderJsonString(p, getDiagnosticName(diagnostic->code, diagnostic->severity));
+    p += sprintf(p, ",\"severity\":\"%s\",\"message\":", severities[diagnostic->severity]);
 
-    fprintf(warningsFile, "\n######################################################################\n");
-    fprintf(warningsFile, "Warning!! in %s on line number %d\n", (*filePath)(), (*line)());
-    switch (err)
+    if (diagnostic->severity == failureDiagnostic)
     {
-
-    case emptyDataDeclaretion:
-        fprintf(warningsFile, "empty Data Declaretion");
-        break;
-
-    case emptyExternalDeclaretion:
-        fprintf(warningsFile, "empty external Declatretion");
-        break;
-
-    case emptyEntryDeclaretion:
-        fprintf(warningsFile, "empty entry Declatretion");
-        break;
-    case emptyDeclaretionOfEntryOrExternalVariables:
-        fprintf(warningsFile, "empty Declaretion Of Entry Or External Variables");
-        break;
-    case instructionHasNoArguments:
-        fprintf(warningsFile, "instruction Has No Arguments");
-        break;
-
-    default:
-        break;
+        snprintf(message, sizeof(message), "%s %s file", getDiagnosticMessage(diagnostic->code, diagnostic->severity), diagnosticFiles[diagnostic->argId]);
+        p += renderJsonString(p, message);
     }
+    else
+        p += renderJsonString(p, getDiagnosticMessage(diagnostic->code, diagnostic->severity));
 
-    fprintf(warningsFile, "\n");
-    fprintf(warningsFile, "######################################################################\n\n");
+    p += sprintf(p, "}\n");
+    return (size_t)(p - dst);
 }
 
-void reportErrorIntoFile(Error err, char *fileName)
+/**
+ * addDiagnostic
+ * -------------
+ * Records a diagnostic of the current source file. If it can not be recorded,
+ * it is written to stderr at once instead.
+ *
+ * Parameters:
+ * - code: The Error or Warning code.
+ * - severity: The kind of the diagnostic.
+ * - fileName: The file the diagnostic is about.
+ * - lineNumber: The line number the diagnostic is about.
+ */
+static void addDiagnostic(int code, DiagnosticSeverity severity, char *fileName, int lineNumber)
 {
-    extern FILE *errorsFile;
-    extern Bool isErrorFileExist;
-
-    LogFiles *logFile = getLogFiles(fileName);
-    openErrorLogFile(logFile);
-    errorsFile = logFiles->errorsFile;
+    Diagnostic *grown;
+    int fileId = getDiagnosticFileId(fileName != NULL ? fileName : "");
 
-    if (!isErrorFileExist)
+    if (fileId != -1 && diagnosticsCount == diagnosticsCapacity)
     {
-        if (errorsFile == NULL)
-            printf("Failed to open error log file\n");
+        int newCapacity = diagnosticsCapacity ? diagnosticsCapacity * 2 : DIAGNOSTICS_INITIAL_SIZE;
+        if ((grown = (Diagnostic *)realloc(diagnostics, newCapacity * sizeof(Diagnostic))) == NULL)
+            fileId = -1;
         else
-            isErrorFileExist = True;
+        {
+            diagnostics = grown;
+            diagnosticsCapacity = newCapacity;
+        }
     }
 
-    fprintf(errorsFile, "\n######################################################################\n");
-    fprintf(errorsFile, "Error!! occured in %s on line number %d\n", (*filePath)(), (*line)());
-
-    switch (err)
-    {
-    case macroDeclaretionWithoutDefiningMacroName:
-        fprintf(errorsFile, "Macro declaration without defining macro name!");
-        break;
-
-    case illegalInputPassedAsOperandSrcOperand:
-        fprintf(errorsFile, "illegal operands input passed to source operand ");
-        break;
-
-    case illegalInputPassedAsOperandDesOperand:
-        fprintf(errorsFile, "illegal operands input passed to destination operand ");
-        break;
-    case undefinedLabelDeclaretion:
-        fprintf(errorsFile, "undefined Label Declaretion");
-        break;
-    case emptyLabelDecleration:
-        fprintf(errorsFile, "empty Label Declaretion");
-        break;
-    case emptyStringDeclatretion:
-        fprintf(errorsFile, "empty String Declatretion");
-        break;
-    case missingSpaceBetweenLabelDeclaretionAndInstruction:
-        fprintf(errorsFile, "Missing space between label declaretion and instruction name");
-        break;
-    case extraOperandsPassed:
-        fprintf(errorsFile, "Extra operands passed as paramters");
-        break;
-    case wrongCommasSyntaxIllegalApearenceOfCommasInLine:
-        fprintf(errorsFile, "Illegal apearence of commas in line");
-        break;
-    case wrongCommasSyntaxExtra:
-        fprintf(errorsFile, "Extra commas between arguments");
-        break;
-
-    case wrongCommasSyntaxMissing:
-        fprintf(errorsFile, "Missing Commas between arguments");
-        break;
-    case illegalLabelNameLength:
-        fprintf(errorsFile, "illegal Label Name length is greater than the maximum allowed which is %d characters", MAX_LABEL_LEN);
-        break;
-    case illegalLabelNameUseOfSavedKeywordUsingOperationName:
-        fprintf(errorsFile, "illegal Label Name Use Of Saved Keyword.\nUsing Operation Name is not allowed");
-        break;
-
-    case illegalLabelNameUseOfSavedKeywordUsingRegisteryName:
-        fprintf(errorsFile, "illegal Label Name Use Of Saved Keyword.\nUsing Registery Name is not allowed");
-        break;
-
-    case illegalLabelNameUseOfSavedKeywords:
-        fprintf(errorsFile, "illegal Label Name Use Of Saved Keyword.\n");
-        break;
-    case desOperandTypeIsNotAllowed:
-        fprintf(errorsFile, "type of destination operand passed to operation is not accepted!");
-        break;
-
-    case srcOperandTypeIsNotAllowed:
-        fprintf(errorsFile, "type of source operand passed to operation is not accepted!");
-        break;
-    case illegalOverrideOfLocalSymbolWithExternalSymbol:
-        fprintf(errorsFile, "symbol already declared and defined locally,\nso it could not be re-declared as external variable.");
-        break;
-    case illegalApearenceOfCharactersInTheEndOfTheLine:
-        fprintf(errorsFile, "illegal apearence of extra characters in the end of the line");
-        break;
-    case afterPlusOrMinusSignThereMustBeANumber:
-        fprintf(errorsFile, "after Plus Or Minus Sign There Must Be A Number without any spaces between");
-        break;
-
-    case useOfNestedMacrosIsIllegal:
+    if (fileId == -1)
     {
-        fprintf(errorsFile, "useOfNestedMacrosIsIllegal");
-        break;
+        fprintf(stderr, "\n%s\n%s (%s, line %d)\n%s\n", DIAGNOSTICS_SEPARATOR, getDiagnosticMessage(code, severity), fileName, lineNumber, DIAGNOSTICS_SEPARATOR);
+        return;
     }
 
-    case macroClosingWithoutAnyOpenedMacro:
-        fprintf(errorsFile, "macroClosingWithoutAnyOpenedMacro");
-        break;
-    case missinSpaceAfterInstruction:
-    {
-        fprintf(errorsFile, "missin Space between instruction and arguments");
-        break;
-    }
-    case illegalApearenceOfCommaBeforeFirstParameter:
-    {
-        fprintf(errorsFile, "Illegal appearence of a comma before the first parameter");
-        break;
-    }
-    case illegalApearenceOfCommaAfterLastParameter:
-    {
-        fprintf(errorsFile, "Illegal appearence of a comma after the last parameter");
-        break;
-    }
-
-    case wrongInstructionSyntaxIllegalCommaPosition:
-    {
-        fprintf(errorsFile, "comma appearence on line is illegal!");
-        break;
-    }
-    case labelNotExist:
-    {
-        fprintf(errorsFile, "undefined label name, label name was not found in symbol table, assembler compilation faild, not files were created");
-        break;
-    }
+    diagnostics[diagnosticsCount].code = code;
+    diagnostics[diagnosticsCount].severity = severity;
+    diagnostics[diagnosticsCount].fileId = fileId;
+    diagnostics[diagnosticsCount].line = lineNumber;
+    diagnostics[diagnosticsCount].argId = fileId;
+    diagnosticsCount++;
+}
 
-    case operandTypeDoNotMatch:
-    {
-        fprintf(errorsFile, "Operand type does not fit to current operation");
-        break;
-    }
-    case entryDeclaredButNotDefined:
-        fprintf(errorsFile, "operand is registered as .entry in table but is not defined in the file");
-        break;
-    case requiredSourceOperandIsMissin:
-    {
-        fprintf(errorsFile, "required source operand is missing");
-        break;
-    }
+void fileCreationFailure(char *fileName)
+{
+    addDiagnostic(fileCouldNotBeCreated, failureDiagnostic, fileName, 0);
+}
 
-    case requiredDestinationOperandIsMissin:
-    {
-        fprintf(errorsFile, "required destination operand is missing");
-        break;
-    }
-    case illegalMacroNameUseOfSavedKeywords:
-        fprintf(errorsFile, "illegal Macro Name Use Of Saved Keywords");
-        break;
-    case wrongRegisteryReferenceUndefinedReg:
-        fprintf(errorsFile, "undefined registery, registeries names are r0 - r7");
-        break;
-
-    case fileCouldNotBeOpened:
-        fprintf(errorsFile, "file could not be  opened");
-        break;
-
-    case illegalOverrideOfExternalSymbol:
-        fprintf(errorsFile, "Overriding of external symbol exisiting in table is not allowed!");
-        break;
-    case memoryAllocationFailure:
-        fprintf(errorsFile, "memory allocation failed");
-        break;
-    case undefinedOperation:
-        fprintf(errorsFile, "undefined operation name");
-        break;
-    case undefinedInstruction:
-        fprintf(errorsFile, "undefined instruction name");
-        break;
-    case tooMuchArgumentsPassed:
-        fprintf(errorsFile, "too Much Arguments Passed");
-        break;
-    case notEnoughArgumentsPassed:
-        fprintf(errorsFile, "too little arguments passed");
-        break;
-    case symbolDoesNotExist:
-        fprintf(errorsFile, "symbol does not exist");
-        break;
-    case macroDoesNotExist:
-        fprintf(errorsFile, "macro does not exist");
-        break;
-    case wrongArgumentTypePassedAsParam:
-        fprintf(errorsFile, "wrong Argument Type Passed As Param");
-        break;
-    case illegalMacroNameUseOfCharacters:
-        fprintf(errorsFile, "illegal Macro Name Use Of Characters");
-        break;
-    case illegalLabelNameUseOfCharacters:
-        fprintf(errorsFile, "illegal Label Name Use Of Characters");
-        break;
-
-    case illegalLabelDeclaration:
-        fprintf(errorsFile, "illegal Label Declaration");
-        break;
-    case illegalMacroNameLength:
-        fprintf(errorsFile, "illegal Macro Name Length");
-        break;
-    case illegalSymbolNameAlreadyInUse:
-        fprintf(errorsFile, "Label Name Already In Use");
-        break;
-    case illegalMacroNameAlreadyInUse:
-        fprintf(errorsFile, "Macro Name Already In Use");
-        break;
-    case wrongArgumentTypeNotAnInteger:
-        fprintf(errorsFile, "Number must be an integer!");
-        break;
-    case expectedNumber:
-        fprintf(errorsFile, "expected number but got letter instead, argument must be an integer number");
-        break;
-
-    case symbolCannotBeBothCurrentTypeAndRequestedType:
-        fprintf(errorsFile, "symbol Cannot Be Both Current Type And Requested Type");
-        break;
-    case illegalLabelUseExpectedOperationOrInstruction:
-        fprintf(errorsFile, "illegal Label Use Expected Operation Or Instruction");
-        break;
-    case wrongInstructionSyntaxMissinCommas:
-    {
-        fprintf(errorsFile, "Missing Comma between argumentes");
-        break;
-    }
+void fileOpeningFailure(char *fileName)
+{
+    addDiagnostic(fileCouldNotBeOpened, failureDiagnostic, fileName, 0);
+}
 
-    case wrongOperationSyntaxMissingCommas:
-        fprintf(errorsFile, "Missing Comma between operands");
-        break;
-    case wrongOperationSyntaxExtraCommas:
-        fprintf(errorsFile, "Extra Comma between operands");
-        break;
+Bool reportWarning(Warning err)
+{
+    addDiagnostic(err, warningDiagnostic, (*filePath)(), (*line)());
+    return True;
+}
 
-    case wrongInstructionSyntaxExtraCommas:
+Bool reportError(Error err)
+{
+    if (isErrorLimitReached())
     {
-        fprintf(errorsFile, "extra comma between arguments");
-        break;
+        suppressedErrorsCount++;
+        return False;
     }
 
-    case expectedSingleCommaCharacter:
-        fprintf(errorsFile, "Missing Comma");
-        break;
-    case illegalApearenceOfCharactersOnLine:
-        fprintf(errorsFile, "Illegal use of characters");
-        break;
-    case undefinedTokenNotOperationOrInstructionOrLabel:
-        fprintf(errorsFile, "illegal token in beginning of current line,  not operation nor instruction or label decleration");
-        break;
-    case illegalApearenceOfExtraCharactersOnLine:
-        fprintf(errorsFile, "Illegal appearence of extra characters after the end or before begning of the line");
-        break;
-
-    case illegalApearenceOfCharacterInTheBegningOfTheLine:
-        fprintf(errorsFile, "Illegal appearence of characters at beginning of the line");
-        break;
-
-    case expectedQuotes:
-        fprintf(errorsFile, "expected opening quotes before string");
-        break;
-
-    case closingQuotesForStringIsMissing:
-        fprintf(errorsFile, "missin closing quotes of string variable");
-        break;
-
-    case maxLineLengthExceeded:
-        fprintf(errorsFile, "line character length is illegal");
-
-        break;
-    default:
-        break;
-    }
-    fprintf(errorsFile, "\n");
-    fprintf(errorsFile, "######################################################################\n");
+    errorsCount++;
+    addDiagnostic(err, errorDiagnostic, (*filePath)(), (*line)());
+    return False;
 }
 
-Bool reportWarning(Warning err)
+/**
+ * isErrorLimitReached
+ * -------------------
+ * Checks if the number of errors reported for the current source file reached the --max-errors limit,
+ * the passes over the file stop when it does.
+ *
+ * Returns:
+ * - Bool: True if the limit was reached, False otherwise (or if there is no limit).
+ */
+Bool isErrorLimitReached()
 {
-    reportWarningIntoFile(err, (*filePath)());
-    fprintf(stderr, "\n######################################################################\n");
-    fprintf(stderr, "Warning!! in %s on line number %d\n", (*filePath)(), (*line)());
-    switch (err)
-    {
+    return getMaxErrors() > 0 && errorsCount >= getMaxErrors() ? True : False;
+}
 
-    case emptyDataDeclaretion:
-        fprintf(stderr, "empty Data Declaretion");
-        break;
+/**
+ * countDiagnostics
+ * ----------------
+ * Counts the diagnostics of a kind that were reported for the current source file, before they are flushed.
+ *
+ * Parameters:
+ * - severity: The kind of the diagnostics.
+ *
+ * Returns:
+ * - int: The number of diagnostics, the errors include those that were not recorded after the --max-errors limit.
+ */
+int countDiagnostics(DiagnosticSeverity severity)
+{
+    int i, count = severity == errorDiagnostic ? suppressedErrorsCount : 0;
 
-    case emptyExternalDeclaretion:
-        fprintf(stderr, "empty external Declatretion");
-        break;
+    for (i = 0; i < diagnosticsCount; i++)
+        if (diagnostics[i].severity == severity)
+            count++;
+    return count;
+}
 
-    case emptyEntryDeclaretion:
-        fprintf(stderr, "empty entry Declatretion");
-        break;
-    case emptyDeclaretionOfEntryOrExternalVariables:
-        fprintf(stderr, "empty Declaretion Of Entry Or External Variables");
-        break;
-    case instructionHasNoArguments:
-        fprintf(stderr, "instruction Has No Arguments");
-        break;
+/**
+ * renderSuppressedErrorsSummary
+ * -----------------------------
+ * Writes the summary of a file whose processing was stopped by the --max-errors limit,
+ * with the number of errors that were found after the limit and not reported.
+ *
+ * Parameters:
+ * - dst: The destination, with room for DIAGNOSTIC_TEXT_MAX_EXTRA_LEN characters.
+ *
+ * Returns:
+ * - size_t: The number of characters written.
+ */
+static size_t renderSuppressedErrorsSummary(char *dst)
+{
+    return sprintf(dst, "\n%s\nStopped after %d errors (%s), %d more errors were suppressed and the rest of the file was not checked\n%s\n",
+                   DIAGNOSTICS_SEPARATOR, getMaxErrors(), MAX_ERRORS_OPTION, suppressedErrorsCount, DIAGNOSTICS_SEPARATOR);
+}
 
-    default:
-        break;
-    }
+/**
+ * renderSuppressedErrorsJson
+ * --------------------------
+ * Writes the summary of a file whose processing was stopped by the --max-errors limit
+ * as a JSON object, in the format of the JSON diagnostics.
+ *
+ * Parameters:
+ * - fileId: The file the summary belongs to.
+ * - dst: The destination, with room for JSON_ESCAPE_MAX_LEN characters for each character of the file name, and DIAGNOSTIC_TEXT_MAX_EXTRA_LEN more.
+ *
+ * Returns:
+ * - size_t: The number of characters written.
+ */
+static size_t renderSuppressedErrorsJson(int fileId, char *dst)
+{
+    char *p = dst;
 
-    fprintf(stderr, "\n");
-    fprintf(stderr, "######################################################################\n\n");
-    return True;
+    p += sprintf(p, "{\"file\":");
+    p += renderJsonString(p, diagnosticFiles[fileId]);
+    p += sprintf(p, ",\"code\":\"maxErrorsReached\",\"severity\":\"note\",\"limit\":%d,\"suppressed\":%d}\n", getMaxErrors(), suppressedErrorsCount);
+    return (size_t)(p - dst);
 }
 
-Bool reportError(Error err)
+/**
+ * writeDiagnosticsJson
+ * --------------------
+ * Writes the diagnostics to stderr as JSON lines (--diagnostics=json), one object for each diagnostic,
+ * followed by the --max-errors summary object if the limit was reached.
+ *
+ * Parameters:
+ * - summaryFileId: The file the summary belongs to.
+ * - isLimitReached: True if the --max-errors summary should be written.
+ */
+static void writeDiagnosticsJson(int summaryFileId, Bool isLimitReached)
 {
-    reportErrorIntoFile(err, (*filePath)());
-    fprintf(stderr, "\n######################################################################\n");
-    fprintf(stderr, "Error!! occured in %s on line number %d\n", (*filePath)(), (*line)());
+    OutputBuffer json;
+    int i;
 
-    switch (err)
-    {
+    initOutputBuffer(&json);
+    for (i = 0; i < diagnosticsCount && reserveOutputBuffer(&json, getDiagnosticJsonMaxLength(&diagnostics[i])); i++)
+        json.length += renderDiagnosticJson(&diagnostics[i], json.data + json.length);
 
-    case macroDeclaretionWithoutDefiningMacroName:
-        fprintf(stderr, "Macro declaration without defining macro name!");
-        break;
-
-    case illegalInputPassedAsOperandSrcOperand:
-        fprintf(stderr, "illegal operands input passed to source operand ");
-        break;
-
-    case illegalInputPassedAsOperandDesOperand:
-        fprintf(stderr, "illegal operands input passed to destination operand ");
-        break;
-    case desOperandTypeIsNotAllowed:
-        fprintf(stderr, "type of destination operand passed to operation is not accepted!");
-        break;
-
-    case srcOperandTypeIsNotAllowed:
-        fprintf(stderr, "type of source operand passed to operation is not accepted!");
-        break;
-    case undefinedLabelDeclaretion:
-        fprintf(stderr, "undefined Label Declaretion");
-        break;
-    case emptyLabelDecleration:
-        fprintf(stderr, "empty Label Declaretion");
-        break;
-    case emptyStringDeclatretion:
-        fprintf(stderr, "empty String Declatretion");
-        break;
-    case missingSpaceBetweenLabelDeclaretionAndInstruction:
-        fprintf(stderr, "Missing space between label declaretion and instruction name");
-        break;
-    case illegalLabelNameLength:
-        fprintf(stderr, "illegal Label Name length is greater than the maximum allowed which is %d characters", MAX_LABEL_LEN);
-        break;
-    case extraOperandsPassed:
-        fprintf(stderr, "Extra operands passed as paramters");
-        break;
-
-    case wrongCommasSyntaxIllegalApearenceOfCommasInLine:
-        fprintf(stderr, "Illegal apearence of commas in line");
-        break;
-    case wrongCommasSyntaxExtra:
-        fprintf(stderr, "Extra commas between arguments");
-        break;
-
-    case wrongCommasSyntaxMissing:
-        fprintf(stderr, "Missing Commas between arguments");
-        break;
-
-    case illegalLabelNameUseOfSavedKeywordUsingOperationName:
-        fprintf(stderr, "illegal Label Name Use Of Saved Keyword.\nUsing Operation Name is not allowed");
-        break;
-
-    case illegalLabelNameUseOfSavedKeywordUsingRegisteryName:
-        fprintf(stderr, "illegal Label Name Use Of Saved Keyword.\nUsing Registery Name is not allowed");
-        break;
-
-    case illegalLabelNameUseOfSavedKeywords:
-        fprintf(stderr, "illegal Label Name Use Of Saved Keyword.\n");
-        break;
-
-    case illegalOverrideOfLocalSymbolWithExternalSymbol:
-        fprintf(stderr, "symbol already declared and defined locally,\nso it could not be re-declared as external variable.");
-        break;
-    case illegalApearenceOfCharactersInTheEndOfTheLine:
-        fprintf(stderr, "illegal apearence of extra characters in the end of the line");
-        break;
-    case afterPlusOrMinusSignThereMustBeANumber:
-        fprintf(stderr, "after Plus Or Minus Sign There Must Be A Number without any spaces between");
-        break;
-
-    case useOfNestedMacrosIsIllegal:
-    {
-        fprintf(stderr, "useOfNestedMacrosIsIllegal");
-        break;
-    }
+    if (isLimitReached && summaryFileId >= 0 &&
+        reserveOutputBuffer(&json, strlen(diagnosticFiles[summaryFileId]) * JSON_ESCAPE_MAX_LEN + DIAGNOSTIC_TEXT_MAX_EXTRA_LEN))
+        json.length += renderSuppressedErrorsJson(summaryFileId, json.data + json.length);
 
-    case macroClosingWithoutAnyOpenedMacro:
-        fprintf(stderr, "macroClosingWithoutAnyOpenedMacro");
-        break;
-    case missinSpaceAfterInstruction:
-    {
-        fprintf(stderr, "missin Space between instruction and arguments");
-        break;
-    }
-    case illegalApearenceOfCommaBeforeFirstParameter:
-    {
-        fprintf(stderr, "Illegal appearence of a comma before the first parameter");
-        break;
-    }
-    case illegalApearenceOfCommaAfterLastParameter:
-    {
-        fprintf(stderr, "Illegal appearence of a comma after the last parameter");
-        break;
-    }
+    fwrite(json.data, 1, json.length, stderr);
+    freeOutputBuffer(&json);
+}
 
-    case wrongInstructionSyntaxIllegalCommaPosition:
-    {
-        fprintf(stderr, "comma appearence on line is illegal!");
-        break;
-    }
-    case labelNotExist:
-    {
-        fprintf(stderr, "undefined label name, label name was not found in symbol table, assembler compilation faild, not files were created");
-        break;
-    }
+/**
+ * writeLogFile
+ * ------------
+ * Writes the diagnostics of one file that belong to one log file (errors or warnings) at once.
+ *
+ * Parameters:
+ * - fileId: The file the log belongs to.
+ * - isWarningsLog: True for the warnings log, False for the errors log.
+ * - text: The rendered text of all the diagnostics.
+ * - ends: The end offset of each diagnostic in text.
+ * - summary: Text written after the diagnostics, if any of them was written (may be NULL).
+ */
+static void writeLogFile(int fileId, Bool isWarningsLog, char *text, size_t *ends, char *summary)
+{
+    char *suffix = isWarningsLog ? WARNINGS_LOG_SUFFIX : ERRORS_LOG_SUFFIX;
+    char logFileName[MAX_FILENAME_LEN];
+    FILE *logFile = NULL;
+    int i;
 
-    case operandTypeDoNotMatch:
+    for (i = 0; i < diagnosticsCount; i++)
     {
-        fprintf(stderr, "Operand type does not fit to current operation");
-        break;
-    }
-    case entryDeclaredButNotDefined:
-        fprintf(stderr, "operand is registered as .entry in table but is not defined in the file");
-        break;
-    case requiredSourceOperandIsMissin:
-    {
-        fprintf(stderr, "required source operand is missing");
-        break;
-    }
+        if (diagnostics[i].fileId != fileId || (diagnostics[i].severity == warningDiagnostic) != isWarningsLog)
+            continue;
 
-    case requiredDestinationOperandIsMissin:
-    {
-        fprintf(stderr, "required destination operand is missing");
-        break;
-    }
-    case illegalMacroNameUseOfSavedKeywords:
-        fprintf(stderr, "illegal Macro Name Use Of Saved Keywords");
-        break;
-    case wrongRegisteryReferenceUndefinedReg:
-        fprintf(stderr, "undefined registery, registeries names are r0 - r7");
-        break;
-
-    case fileCouldNotBeOpened:
-        fprintf(stderr, "file could not be  opened");
-        break;
-
-    case illegalOverrideOfExternalSymbol:
-        fprintf(stderr, "Overriding of external symbol exisiting in table is not allowed!");
-        break;
-    case memoryAllocationFailure:
-        fprintf(stderr, "memory allocation failed");
-        break;
-    case undefinedOperation:
-        fprintf(stderr, "undefined operation name");
-        break;
-    case undefinedInstruction:
-        fprintf(stderr, "undefined instruction name");
-        break;
-    case tooMuchArgumentsPassed:
-        fprintf(stderr, "too Much Arguments Passed");
-        break;
-    case notEnoughArgumentsPassed:
-        fprintf(stderr, "too little arguments passed");
-        break;
-    case symbolDoesNotExist:
-        fprintf(stderr, "symbol does not exist");
-        break;
-    case macroDoesNotExist:
-        fprintf(stderr, "macro does not exist");
-        break;
-    case wrongArgumentTypePassedAsParam:
-        fprintf(stderr, "wrong Argument Type Passed As Param");
-        break;
-    case illegalMacroNameUseOfCharacters:
-        fprintf(stderr, "illegal Macro Name Use Of Characters");
-        break;
-    case illegalLabelNameUseOfCharacters:
-        fprintf(stderr, "illegal Label Name Use Of Characters");
-        break;
-
-    case illegalLabelDeclaration:
-        fprintf(stderr, "illegal Label Declaration");
-        break;
-    case illegalMacroNameLength:
-        fprintf(stderr, "illegal Macro Name Length");
-        break;
-    case illegalSymbolNameAlreadyInUse:
-        fprintf(stderr, "Label Name Already In Use");
-        break;
-    case illegalMacroNameAlreadyInUse:
-        fprintf(stderr, "Macro Name Already In Use");
-        break;
-    case wrongArgumentTypeNotAnInteger:
-        fprintf(stderr, "Number must be an integer!");
-        break;
-    case expectedNumber:
-        fprintf(stderr, "expected number but got letter instead, argument must be an integer number");
-        break;
-
-    case symbolCannotBeBothCurrentTypeAndRequestedType:
-        fprintf(stderr, "symbol Cannot Be Both Current Type And Requested Type");
-        break;
-    case illegalLabelUseExpectedOperationOrInstruction:
-        fprintf(stderr, "illegal Label Use Expected Operation Or Instruction");
-        break;
-    case wrongInstructionSyntaxMissinCommas:
-    {
-        fprintf(stderr, "Missing Comma between argumentes");
-        break;
+        if (logFile == NULL)
+        {
+            snprintf(logFileName, MAX_FILENAME_LEN, "%s%s", diagnosticFiles[fileId], suffix);
+            if ((logFile = fopen(logFileName, "w")) == NULL)
+            {
+                fprintf(stderr, "ERROR: Failed to create %s\n", logFileName);
+                return;
+            }
+        }
+        fwrite(text + (i ? ends[i - 1] : 0), 1, ends[i] - (i ? ends[i - 1] : 0), logFile);
     }
 
-    case wrongOperationSyntaxMissingCommas:
-        fprintf(stderr, "Missing Comma between operands");
-        break;
-    case wrongOperationSyntaxExtraCommas:
-        fprintf(stderr, "Extra Comma between operands");
-        break;
-
-    case wrongInstructionSyntaxExtraCommas:
+    if (logFile != NULL)
     {
-        fprintf(stderr, "extra comma between arguments");
-        break;
-    }
-
-    case expectedSingleCommaCharacter:
-        fprintf(stderr, "Missing Comma");
-        break;
-    case illegalApearenceOfCharactersOnLine:
-        fprintf(stderr, "Illegal use of characters");
-        break;
-    case undefinedTokenNotOperationOrInstructionOrLabel:
-        fprintf(stderr, "illegal token in beginning of current line,  not operation nor instruction or label decleration");
-        break;
-    case illegalApearenceOfExtraCharactersOnLine:
-        fprintf(stderr, "Illegal appearence of extra characters after the end or before begning of the line");
-        break;
-
-    case illegalApearenceOfCharacterInTheBegningOfTheLine:
-        fprintf(stderr, "Illegal appearence of characters at beginning of the line");
-        break;
-
-    case expectedQuotes:
-        fprintf(stderr, "expected opening quotes before string");
-        break;
-
-    case closingQuotesForStringIsMissing:
-        fprintf(stderr, "missin closing quotes of string variable");
-        break;
-
-    case maxLineLengthExceeded:
-        fprintf(stderr, "line character length is illegal");
-
-        break;
-    default:
-        break;
+        if (summary != NULL)
+            fputs(summary, logFile);
+        fclose(logFile);
     }
-    fprintf(stderr, "\n");
-    fprintf(stderr, "######################################################################\n");
-
-    return False;
 }
 
-void closeOpenLogFiles()
+/**
+ * flushDiagnostics
+ * ----------------
+ * Renders the diagnostics of the source file that was processed and writes them at once:
+ * all of them to stderr (as text, or as JSON lines with --diagnostics=json), and those of each file
+ * to its errors and warnings log files.
+ * If the --max-errors limit was reached, a summary follows them.
+ * The diagnostics are then cleared for the next source file.
+ */
+void flushDiagnostics()
 {
-    extern FILE *warningsFile, *errorsFile;
-    extern Bool isWarningFileExist, isErrorFileExist;
-    int i = 0;
+    OutputBuffer text;
+    size_t *ends;
+    int i, summaryFileId = diagnosticsCount > 0 ? diagnostics[diagnosticsCount - 1].fileId : -1;
+    char summary[DIAGNOSTIC_TEXT_MAX_EXTRA_LEN];
 
-    for (i = 0; i < logFilesCount; i++)
+    summary[0] = '\0';
+    if (isErrorLimitReached())
+        renderSuppressedErrorsSummary(summary);
+
+    if (diagnosticsCount > 0)
     {
-        if (logFiles[i].warningsFile != NULL)
-        {
-            fclose(logFiles[i].warningsFile);
-        }
-        if (logFiles[i].errorsFile != NULL)
+        initOutputBuffer(&text);
+        if ((ends = (size_t *)malloc(diagnosticsCount * sizeof(size_t))) == NULL)
+            fprintf(stderr, "\nFailed to write %d diagnostics: memory allocation failed\n", diagnosticsCount);
+        else
         {
-            fclose(logFiles[i].errorsFile);
+            for (i = 0; i < diagnosticsCount && reserveOutputBuffer(&text, getDiagnosticTextMaxLength(&diagnostics[i])); i++)
+            {
+                text.length += renderDiagnostic(&diagnostics[i], text.data + text.length);
+                ends[i] = text.length;
+            }
+            diagnosticsCount = i; /* Only the diagnostics that were rendered */
+
+            if (getDiagnosticsFormat() == jsonDiagnostics)
+                writeDiagnosticsJson(summaryFileId, summary[0] ? True : False);
+            else
+            {
+                fwrite(text.data, 1, text.length, stderr);
+                fputs(summary, stderr);
+            }
+            for (i = 0; i < diagnosticFilesCount; i++)
+            {
+                writeLogFile(i, False, text.data, ends, i == summaryFileId && summary[0] ? summary : NULL);
+                writeLogFile(i, True, text.data, ends, NULL);
+            }
+            free(ends);
         }
+        freeOutputBuffer(&text);
     }
 
-    if (isWarningFileExist && warningsFile != NULL)
-    {
-        fclose(warningsFile);
-        isWarningFileExist = False;
-    }
-    if (isErrorFileExist && errorsFile != NULL)
-    {
-        fclose(errorsFile);
-        isErrorFileExist = False;
-    }
+    for (i = 0; i < diagnosticFilesCount; i++)
+        free(diagnosticFiles[i]);
+    diagnosticFilesCount = 0;
+    diagnosticsCount = 0;
+    errorsCount = suppressedErrorsCount = 0;
+}
 
-    /* Free the logFiles array */
-    free(logFiles);
-    logFiles = NULL;
-    logFilesCount = 0;
+/**
+ * freeDiagnostics
+ * ---------------
+ * Frees the diagnostics buffers, at the end of the run.
+ */
+void freeDiagnostics()
+{
+    flushDiagnostics();
+    free(diagnostics);
+    free(diagnosticFiles);
+    diagnostics = NULL;
+    diagnosticFiles = NULL;
+    diagnosticsCapacity = diagnosticFilesCapacity = 0;
 }
@@ -70,7 +70,7 @@ Bool handleOperation(char *operationName, char *args)
         active[1].direct = active[1].immediate = active[1].indirect = active[1].reg = 0;
 
         /* Increase the instruction counter by the calculated size */
-        increaseInstructionCounter(size);
+        areOperandsLegal = increaseInstructionCounter(size);
     }
 
     return areOperandsLegal;
@@ -244,24 +244,23 @@ Bool handleInstruction(int type, char *firstToken, char *nextTokens, char *line)
             if (nextTokens)
             {
                 char *labelName = cloneString(nextTokens); /* Clone the label name */
-                nextTokens = strtok(NULL, " \t\n\f\r");    /* Check if more tokens exist */
+                Bool isAdded = False;
+                nextTokens = strtok(NULL, " \t\n\f\r"); /* Check if more tokens exist */
 
                 /* If there are extra tokens, log an error */
                 if (nextTokens)
-                {
                     reportError(illegalApearenceOfCharactersInTheEndOfTheLine);
-                    return False;
-                }
                 else
                 {
-                    /* Handle entry or external label definition */
+                    /* Handle entry or external label definition, the symbol table keeps its own copy of the name */
                     if (type == _TYPE_ENTRY)
-                        return addSymbol(labelName, 0, 0, 0, 1, 0) ? True : False;
+                        isAdded = addSymbol(labelName, 0, 0, 0, 1, 0) ? True : False;
                     if (type == _TYPE_EXTERNAL)
-                        return addSymbol(labelName, 0, 0, 0, 0, 1) ? True : False;
+                        isAdded = addSymbol(labelName, 0, 0, 0, 0, 1) ? True : False;
                 }
 
                 free(labelName); /* Free the cloned label name after processing */
+                return isAdded;
             }
             else
             {
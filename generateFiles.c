@@ -5,74 +5,239 @@ static char *(*baseFileName)() = &getFileNamePath;
 
 /*  void exportFiles()
     This function is responsible for exporting the .ob, .ent, and .ext files.
-    It creates the .ob file first, then generates the .ent file if any entry labels exist,
-    and the .ext file if any external labels exist.*/
+    The base file name is fetched once, and each output file name is built by
+    appending the extension to it. It creates the .ob file first, then generates
+    the .ent file if any entry labels exist, and the .ext file if any external labels exist.*/
 
 void exportFiles()
 {
-    printf("Finished Successfully, about to export files!\n");
-    createObFile();
+    char *baseName = (*baseFileName)();
+    size_t baseLength = strlen(baseName);
+    char *fileName = (char *)malloc(baseLength + MAX_EXTENSION_LEN);
+
+    if (isVerbose(debugVerbosity))
+        printf("Finished Successfully, about to export files!\n");
+
+    if (fileName == NULL)
+    {
+        reportError(memoryAllocationFailure);
+        free(baseName);
+        return;
+    }
+
+    strcpy(fileName, baseName);
+
+    strcpy(fileName + baseLength, ".ob");
+    createObFile(fileName);
+
     if (areEntriesExist())
-        createEntriesFile();
+    {
+        strcpy(fileName + baseLength, ".ent");
+        createEntriesFile(fileName);
+    }
     if (areExternalsExist())
-        createExternalsFile();
+    {
+        strcpy(fileName + baseLength, ".ext");
+        createExternalsFile(fileName);
+    }
+
+    free(fileName);
+    free(baseName);
 }
 
-/* void createObFile()
-    This function creates the .ob file by writing the memory image.
+/* void createObFile(char *fileName)
+    This function creates the .ob file from two buffers, the header line and the lines
+    of the memory image words, that are written together in one vectored write.
     If the file can't be created, an error is logged. */
-void createObFile()
+void createObFile(char *fileName)
 {
-    FILE *ob;
-    char *fileName = (*baseFileName)();
-    strcat(fileName, ".ob");
-    ob = fopen(fileName, "w+");
+    char headerText[OB_HEADER_MAX_LEN];
+    OutputBuffer parts[2];
 
-    if (ob != NULL)
+    parts[0].data = headerText;
+    parts[0].capacity = OB_HEADER_MAX_LEN;
+    parts[0].length = formatMemoryImageHeader(headerText);
+
+    initOutputBuffer(&parts[1]);
+    if (!reserveOutputBuffer(&parts[1], getMemoryImageTextMaxLength()))
     {
-        writeMemoryImageToObFile(ob);
-        fclose(ob);
-        free(fileName);
+        reportError(memoryAllocationFailure);
+        return;
     }
-    else
+    parts[1].length = formatMemoryImageWords(parts[1].data);
+
+    if (!publishOutputFile(fileName, parts, 2))
         fileCreationFailure(fileName);
+
+    freeOutputBuffer(&parts[1]);
 }
 
-/* void createEntriesFile()
-    This function generates the .ent file if there are entry labels by writing
-    the necessary data. If the file can't be created, an error is logged. */
-void createEntriesFile()
+/* void createEntriesFile(char *fileName)
+    This function generates the .ent file if there are entry labels by building
+    the necessary data in memory and writing it at once. If the file can't be created, an error is logged. */
+void createEntriesFile(char *fileName)
 {
-    FILE *ent;
-    char *fileName = (*baseFileName)();
-    strcat(fileName, ".ent");
-    ent = fopen(fileName, "w+");
+    OutputBuffer ent;
+    initOutputBuffer(&ent);
 
-    if (ent != NULL)
-    {
-        writeEntriesToFile(ent);
-        fclose(ent);
-        free(fileName);
-    }
-    else
+    if (!writeEntriesToBuffer(&ent))
+        reportError(memoryAllocationFailure);
+    else if (!publishOutputFile(fileName, &ent, 1))
         fileCreationFailure(fileName);
+
+    freeOutputBuffer(&ent);
 }
 
-/* void createExternalsFile()
+/* void createExternalsFile(char *fileName)
     This function generates the .ext file if there are external labels.
-    It writes the data to the file. If the file can't be created, an error is logged. */
-void createExternalsFile()
+    It builds the data in memory and writes it at once. If the file can't be created, an error is logged. */
+void createExternalsFile(char *fileName)
+{
+    OutputBuffer ext;
+    initOutputBuffer(&ext);
+
+    if (!writeExternalsToBuffer(&ext))
+        reportError(memoryAllocationFailure);
+    else if (!publishOutputFile(fileName, &ext, 1))
+        fileCreationFailure(fileName);
+
+    freeOutputBuffer(&ext);
+}
+
+/* void initOutputBuffer(OutputBuffer *buffer)
+    This function initializes an empty output buffer, no memory is allocated until data is added. */
+void initOutputBuffer(OutputBuffer *buffer)
 {
-    FILE *ext;
-    char *fileName = (*baseFileName)();
-    strcat(fileName, ".ext");
-    ext = fopen(fileName, "w+");
-    if (ext != NULL)
+    buffer->data = NULL;
+    buffer->length = 0;
+    buffer->capacity = 0;
+}
+
+/* Bool reserveOutputBuffer(OutputBuffer *buffer, size_t extra)
+    This function makes sure the buffer has room for extra characters after its current content.
+    The capacity at least doubles on each growth so appending line by line stays linear.
+    Returns False if the memory could not be allocated. */
+Bool reserveOutputBuffer(OutputBuffer *buffer, size_t extra)
+{
+    size_t capacity = buffer->capacity ? buffer->capacity : OUTPUT_BUFFER_INITIAL_SIZE;
+    char *data;
+
+    if (buffer->length + extra <= buffer->capacity)
+        return True;
+
+    while (capacity < buffer->length + extra)
+        capacity *= 2;
+
+    if ((data = (char *)realloc(buffer->data, capacity)) == NULL)
+        return False;
+
+    buffer->data = data;
+    buffer->capacity = capacity;
+    return True;
+}
+
+/* Bool appendSymbolLine(OutputBuffer *buffer, char *name, unsigned address)
+    This function appends a "name address" line, as used in the .ent and .ext files,
+    with the address padded to four digits.
+    Returns False if the memory could not be allocated. */
+Bool appendSymbolLine(OutputBuffer *buffer, char *name, unsigned address)
+{
+    size_t nameLength = strlen(name);
+    char *p;
+
+    if (!reserveOutputBuffer(buffer, nameLength + SYMBOL_LINE_MAX_LEN))
+        return False;
+
+    p = buffer->data + buffer->length;
+    memcpy(p, name, nameLength);
+    p += nameLength;
+    *p++ = ' ';
+    p += formatDecimal(p, address, OB_ADDRESS_MIN_DIGITS);
+    *p++ = '\n';
+
+    buffer->length = (size_t)(p - buffer->data);
+    return True;
+}
+
+/* void freeOutputBuffer(OutputBuffer *buffer)
+    This function releases the memory of an output buffer and leaves it empty. */
+void freeOutputBuffer(OutputBuffer *buffer)
+{
+    free(buffer->data);
+    initOutputBuffer(buffer);
+}
+
+/* Bool publishOutputFile(char *fileName, OutputBuffer parts[], int count)
+    This function writes the parts of an output file with writev into a temporary file
+    that is created next to the final file, and then renames it to its final name.
+    Since the rename replaces the file at once, other processes never see a partially
+    written output file. On any failure the temporary file is removed and False is returned. */
+Bool publishOutputFile(char *fileName, OutputBuffer parts[], int count)
+{
+    struct iovec vectors[OUTPUT_FILE_MAX_PARTS];
+    char *tempName = (char *)malloc(strlen(fileName) + sizeof(TEMP_FILE_SUFFIX));
+    struct iovec *next = vectors;
+    int i, fd, remaining = 0;
+    mode_t mask;
+    Bool isWritten = True;
+
+    if (tempName == NULL || count > OUTPUT_FILE_MAX_PARTS)
     {
-        writeExternalsToFile(ext);
-        fclose(ext);
-        free(fileName);
+        free(tempName);
+        return False;
     }
-    else
-        fileCreationFailure(fileName);
+
+    strcpy(tempName, fileName);
+    strcat(tempName, TEMP_FILE_SUFFIX);
+    if ((fd = mkstemp(tempName)) == -1)
+    {
+        free(tempName);
+        return False;
+    }
+
+    /* mkstemp creates the file readable by its owner only, give it the permissions fopen would */
+    mask = umask(0);
+    umask(mask);
+    fchmod(fd, OUTPUT_FILE_MODE & ~mask);
+
+    for (i = 0; i < count; i++)
+    {
+        if (parts[i].length == 0)
+            continue;
+        vectors[remaining].iov_base = parts[i].data;
+        vectors[remaining].iov_len = parts[i].length;
+        remaining++;
+    }
+
+    /* writev may write only a part of the data, continue from where it stopped */
+    while (remaining > 0 && isWritten)
+    {
+        ssize_t written = writev(fd, next, remaining);
+        if (written < 0)
+            isWritten = False;
+
+        while (isWritten && remaining > 0 && (size_t)written >= next->iov_len)
+        {
+            written -= next->iov_len;
+            next++;
+            remaining--;
+        }
+        if (isWritten && remaining > 0)
+        {
+            next->iov_base = (char *)next->iov_base + written;
+            next->iov_len -= written;
+        }
+    }
+
+    if (close(fd) != 0)
+        isWritten = False;
+
+    if (!isWritten || rename(tempName, fileName) != 0)
+    {
+        unlink(tempName);
+        isWritten = False;
+    }
+
+    free(tempName);
+    return isWritten;
 }
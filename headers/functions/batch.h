@@ -0,0 +1,24 @@
+
+/*
+-----------------------------------------------------------------------------------------
+--------------------------- batch.c General Overview: ---------------------------
+-----------------------------------------------------------------------------------------
+This module runs the cases of a --batch list in parallel, on --jobs threads (one per processor
+by default). Each line of the list is a case: a .ob file, optionally followed by a space and the
+input its red instructions read. The cases are sorted by their programs and split into equal ranges,
+one per worker. A worker takes the cases of its range one by one, and when its range is empty it
+steals the second half of the range with the most cases left (work stealing), until no cases are left.
+Each worker runs its cases on its own machine, that comes with its snapshot from pools allocated once
+for the run: a program is loaded when the worker gets to its first case, and every other case of it
+restores the snapshot (only the pages the last case wrote to are copied). So no memory is allocated
+per case, besides the growth of the output buffers. The outputs are kept per worker, and printed with
+the reports of the cases in the order of the list, so the output of a batch does not depend on its timing.
+-----------------------------------------------------------------------------------------
+*/
+
+/**
+ * @brief Runs the cases of a --batch list in parallel, and prints their outputs in the order of the list.
+ *
+ * @param fileName The name of the list.
+ */
+void runBatch(char *fileName);
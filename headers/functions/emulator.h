@@ -0,0 +1,132 @@
+
+/*
+-----------------------------------------------------------------------------------------
+--------------------------- emulator.c General Overview: ---------------------------
+-----------------------------------------------------------------------------------------
+This module runs assembled programs on an emulation of the machine they were assembled for (--run).
+A program is loaded from a .ob file, or from the memory image right after its files were exported,
+into a memory of RAM_MEMORY_SIZE words. Before it runs, every instruction of its code is decoded once,
+from the words writeFirstWord and the operand words encode, into a DecodedInstruction of the address
+it starts at, so the emulation loop never decodes bits again. A word of the code that the program
+writes to is decoded again when it is reached. The loop dispatches the operations by direct threading
+(labels as values) when built with GCC, or by a switch when built with -DEMULATOR_SWITCH_DISPATCH.
+The machine has 8 registers, a program status word whose zero flag is set by cmp and tested by bne,
+and a stack for jsr and rts that grows down from the end of the memory. The words are 15 bits wide,
+and the arithmetic wraps around. prn prints the signed value of its operand on a line of its own
+to a buffered stdout, and red reads the next character of stdin (-1 at its end).
+A loaded machine can be snapshotted and restored, to run many cases from the same state without
+loading the program again. The memory is tracked in pages of EMULATOR_PAGE_WORDS words, a write
+marks its page dirty, and a restore copies back only the dirty pages.
+-----------------------------------------------------------------------------------------
+*/
+
+/**
+ * @brief Clears a machine: its registers, program status word and memory, and sets its limits.
+ *
+ * @param machine The machine.
+ */
+void initMachine(Machine *machine);
+
+/**
+ * @brief Loads the memory image of the assembled source file into a cleared machine, and decodes its code.
+ *
+ * @param machine The machine.
+ * @return Bool True if the image was loaded, False if it does not fit in the memory of the machine.
+ */
+Bool loadMemoryImage(Machine *machine);
+
+/**
+ * @brief Loads a .ob file into a cleared machine, and decodes its code.
+ *
+ * @param machine The machine.
+ * @param fileName The name of the .ob file.
+ * @return Bool True if the file was read, False if it could not be opened or is not a legal .ob file.
+ */
+Bool loadObFile(Machine *machine, char *fileName);
+
+/**
+ * @brief Runs the loaded program until it stops, faults, or executes the --max-steps instructions.
+ *
+ * @param machine The machine.
+ * @return MachineStatus The status the program ended with (also kept in the machine).
+ */
+MachineStatus runMachine(Machine *machine);
+
+/**
+ * @brief Returns the text of the status a program ended with.
+ *
+ * @param status The status.
+ * @return char* The text, e.g. "illegal instruction".
+ */
+char *getMachineStatusMessage(MachineStatus status);
+
+/**
+ * @brief Writes the output the program printed so far to the output file of the machine.
+ *
+ * @param machine The machine.
+ */
+void flushMachineOutput(Machine *machine);
+
+/**
+ * @brief Frees the output buffer of a machine.
+ *
+ * @param machine The machine.
+ */
+void freeMachine(Machine *machine);
+
+/**
+ * @brief Copies the full state of a machine to a snapshot, and marks all its pages clean.
+ *
+ * @param machine The machine.
+ * @param snapshot The snapshot, that is overwritten (a snapshot that was taken before must be freed first).
+ * @return Bool False if the memory for the copy of the output could not be allocated.
+ */
+Bool snapshotMachine(Machine *machine, MachineSnapshot *snapshot);
+
+/**
+ * @brief Brings a machine back to the state of a snapshot.
+ *
+ * Only the pages the machine wrote to since it was snapshotted to, or restored from, the same snapshot
+ * are copied; a machine restored from another snapshot is copied whole. The output file and the profile
+ * of the machine are kept.
+ *
+ * @param machine The machine.
+ * @param snapshot The snapshot.
+ */
+void restoreMachine(Machine *machine, const MachineSnapshot *snapshot);
+
+/**
+ * @brief Frees the copy of the output that a snapshot holds.
+ *
+ * @param snapshot The snapshot.
+ */
+void freeMachineSnapshot(MachineSnapshot *snapshot);
+
+/**
+ * @brief Reports how a program ended: an error on stderr if it faulted, and the number of instructions it executed.
+ *
+ * @param name The name of the program in the reports.
+ * @param status The status the program ended with.
+ * @param pc The address the program stopped at.
+ * @param steps The number of instructions the program executed.
+ */
+void reportProgramEnd(char *name, MachineStatus status, unsigned pc, unsigned long steps);
+
+/**
+ * @brief Loads a .ob file and runs it, reporting how the program ended.
+ *
+ * @param fileName The name of the .ob file.
+ */
+void runObFile(char *fileName);
+
+/**
+ * @brief Runs the memory image of the source file that was just assembled, reporting how the program ended.
+ *
+ * @param fileName The base name of the source file, used in the reports.
+ */
+void runAssembledImage(char *fileName);
+
+/**
+ * @brief Frees the standard input that was read for the red instructions, at the end of the run.
+ */
+void freeEmulatorInput();
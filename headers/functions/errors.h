@@ -5,79 +5,81 @@
 This file is used for handling different errors our assembler might encounter during all the stages of the
 assembler. the errors and printed to the stderr and to a %sourceFileName%.am.errors.log file that will be
  created for each source file within source's file directory.
+Reported errors and warnings are recorded as small Diagnostic structs while a source file is processed,
+and are rendered from a single message catalog and written to all the sinks at once when the file is done.
 -------------------------------------------------------------------------------------------------------------
 
 */
 
 /**
- * @brief Finds or creates a log file entry for the given file name.
+ * @brief Returns the catalog text of an error, warning or failure.
  *
- * @param fileName The name of the file for which log files are being handled.
- * @return LogFiles* Pointer to the LogFiles entry for the given file name.
+ * @param code The Error or Warning code.
+ * @param severity The kind of the diagnostic.
+ * @return char* The message text, or an empty string if the code has no message.
  */
-LogFiles *getLogFiles(char *fileName);
+char *getDiagnosticMessage(int code, DiagnosticSeverity severity);
 
 /**
- * @brief Opens an error log file for the specified LogFiles entry.
+ * @brief Returns the name of the code of an error, warning or failure, as written in the JSON diagnostics.
  *
- * @param logFile A pointer to the LogFiles structure that contains file information.
+ * @param code The Error or Warning code.
+ * @param severity The kind of the diagnostic.
+ * @return char* The name of the code in its enum, or "unknown" if the code is not in the catalog.
  */
-void openErrorLogFile(LogFiles *logFile);
+char *getDiagnosticName(int code, DiagnosticSeverity severity);
 
 /**
- * @brief Opens a warning log file for the specified LogFiles entry.
+ * @brief Records a failure to create an output file.
  *
- * @param logFile A pointer to the LogFiles structure that contains file information.
- */
-void openWarningLogFile(LogFiles *logFile);
-
-/**
- * @brief Handles a file creation failure and logs the error.
- *
- * @param fileName The name of the file that failed to be created.
+ * @param fileName The name of the file that could not be created.
  */
 void fileCreationFailure(char *fileName);
 
 /**
- * @brief Handles a file opening failure and logs the error.
+ * @brief Records a failure to open a file.
  *
- * @param fileName The name of the file that failed to open.
+ * @param fileName The name of the file that could not be opened.
  */
 void fileOpeningFailure(char *fileName);
 
 /**
- * @brief Logs a warning to the warning log file for the specified file.
+ * @brief Records a warning of the current file and line, to be written to the console and log file.
  *
  * @param err The warning to log.
- * @param fileName The name of the file for which the warning is being logged.
+ * @return Bool Returns True if the warning was successfully reported.
  */
-void reportWarningIntoFile(Warning err, char *fileName);
+Bool reportWarning(Warning err);
 
 /**
- * @brief Logs an error to the error log file for the specified file.
+ * @brief Records an error of the current file and line, to be written to the console and log file.
  *
  * @param err The error to log.
- * @param fileName The name of the file for which the error is being logged.
+ * @return Bool Returns False after reporting the error.
  */
-void reportErrorIntoFile(Error err, char *fileName);
+Bool reportError(Error err);
 
 /**
- * @brief Reports a warning message to the console and log file.
+ * @brief Checks if the number of errors of the current source file reached the --max-errors limit.
  *
- * @param err The warning to log.
- * @return Bool Returns True if the warning was successfully reported.
+ * @return Bool True if the passes over the file should stop.
  */
-Bool reportWarning(Warning err);
+Bool isErrorLimitReached();
 
 /**
- * @brief Reports an error message to the console and log file.
+ * @brief Counts the diagnostics of a kind that were reported for the current source file, before they are flushed.
  *
- * @param err The error to log.
- * @return Bool Returns False after reporting the error.
+ * @param severity The kind of the diagnostics.
+ * @return int The number of diagnostics, including the errors not recorded after the --max-errors limit.
  */
-Bool reportError(Error err);
+int countDiagnostics(DiagnosticSeverity severity);
+
+/**
+ * @brief Writes the recorded diagnostics of the processed source file to stderr and to the log files at once, and clears them.
+ */
+void flushDiagnostics(void);
 
 /**
- * @brief Closes all open log files and resets the log file system.
+ * @brief Flushes and frees the diagnostics buffers at the end of the run.
  */
-void closeOpenLogFiles(void);
+void freeDiagnostics(void);
@@ -10,4 +10,8 @@
 #include "mem.h"
 #include "first.h"
 #include "second.h"
-#include "generateFiles.h"
\ No newline at end of file
+#include "generateFiles.h"
+#include "stats.h"
+#include "emulator.h"
+#include "profiler.h"
+#include "batch.h"
\ No newline at end of file
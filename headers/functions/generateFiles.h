@@ -5,13 +5,16 @@
 This file handles the generation of the assembler's output files: .ob, .ent, and .ext files.
 The .ob file contains the memory image, the .ent file contains entry labels, and the .ext file
 contains external labels, if any exist.
+Each file is built in memory buffers first, written with one vectored write to a temporary
+file, and then renamed to its final name so a half written file is never visible.
 -----------------------------------------------------------------------------------------
 */
 
 /**
  * @brief Exports the .ob, .ent, and .ext files generated by the assembler.
  *
- * This function calls other functions responsible for generating the required output files:
+ * This function fetches the base file name once and calls other functions responsible for
+ * generating the required output files:
  * - The .ob file (memory image)
  * - The .ent file (entry labels, if any exist)
  * - The .ext file (external labels, if any exist)
@@ -21,23 +24,77 @@ void exportFiles();
 /**
  * @brief Creates the .ob file, which contains the memory image of the assembler's output.
  *
- * This function generates the .ob file by writing the memory image to it.
- * If the file cannot be created, an error is logged.
+ * This function formats the header line and the memory image words into two buffers
+ * and publishes them together as the .ob file. If the file cannot be created, an error is logged.
+ *
+ * @param fileName The full name of the .ob file.
  */
-void createObFile();
+void createObFile(char *fileName);
 
 /**
  * @brief Creates the .ent file, which contains entry labels, if any exist.
  *
- * This function generates the .ent file by writing the necessary data for entry labels.
- * If there are no entry labels, the file is not created. If the file cannot be created, an error is logged.
+ * This function builds the entry labels lines in memory and publishes them as the .ent file.
+ * If the file cannot be created, an error is logged.
+ *
+ * @param fileName The full name of the .ent file.
  */
-void createEntriesFile();
+void createEntriesFile(char *fileName);
 
 /**
  * @brief Creates the .ext file, which contains external labels, if any exist.
  *
- * This function generates the .ext file by writing the necessary data for external labels.
- * If there are no external labels, the file is not created. If the file cannot be created, an error is logged.
+ * This function builds the external labels lines in memory and publishes them as the .ext file.
+ * If the file cannot be created, an error is logged.
+ *
+ * @param fileName The full name of the .ext file.
+ */
+void createExternalsFile(char *fileName);
+
+/**
+ * @brief Initializes an empty output buffer.
+ *
+ * @param buffer The buffer to initialize.
+ */
+void initOutputBuffer(OutputBuffer *buffer);
+
+/**
+ * @brief Makes sure an output buffer has room for more characters.
+ *
+ * @param buffer The buffer to grow.
+ * @param extra The number of characters that should fit after the current content.
+ * @return Bool Returns False if the memory could not be allocated, True otherwise.
+ */
+Bool reserveOutputBuffer(OutputBuffer *buffer, size_t extra);
+
+/**
+ * @brief Appends a "name address" line of the .ent / .ext files to an output buffer.
+ *
+ * @param buffer The buffer to append to.
+ * @param name The symbol name.
+ * @param address The address, written with at least four digits.
+ * @return Bool Returns False if the memory could not be allocated, True otherwise.
+ */
+Bool appendSymbolLine(OutputBuffer *buffer, char *name, unsigned address);
+
+/**
+ * @brief Releases the memory of an output buffer.
+ *
+ * @param buffer The buffer to release.
+ */
+void freeOutputBuffer(OutputBuffer *buffer);
+
+/**
+ * @brief Writes an output file atomically.
+ *
+ * The parts are written with a single vectored write (writev) into a temporary file next to the
+ * final file, which is then renamed to the final name. Other processes either see the previous
+ * file or the complete new one, never a partially written file. On failure the temporary file
+ * is removed.
+ *
+ * @param fileName The final name of the file.
+ * @param parts The buffers to write, in order.
+ * @param count The number of buffers (at most OUTPUT_FILE_MAX_PARTS).
+ * @return Bool Returns True if the file was published, False otherwise.
  */
-void createExternalsFile();
\ No newline at end of file
+Bool publishOutputFile(char *fileName, OutputBuffer parts[], int count);
@@ -3,22 +3,14 @@
 -----------------------------------------------------------------------------------------
 --------------------------- helpers.h General Overview: ---------------------------
 -----------------------------------------------------------------------------------------
-This header file provides utility functions for various string manipulations,
-numeric conversions, and binary-to-octal conversions. The functions included
-handle tasks such as cloning strings, trimming whitespace, converting decimal
-numbers to binary and octal formats, and converting binary words into octal words.
-These utilities are essential for processing assembly instructions and generating
-output in specific formats, such as binary or octal representations.
+This header file provides utility functions for string manipulations.
+The functions included handle tasks such as cloning strings, trimming whitespace
+and writing numbers into output text.
+These utilities are essential for processing the lines of assembly instructions.
 
 Key functionalities provided in this file include:
 - String manipulation functions to duplicate and clean up input strings.
-- Conversion functions for transforming decimal numbers into binary and octal formats.
-- Binary word conversion into octal format, breaking binary sequences into manageable parts.
-- Utility functions for working with assembly code representation in various numeric bases.
-
-These utilities are fundamental in ensuring smooth parsing, transformation, and
-handling of assembly-level operations where precise representation in binary and octal
-is crucial.
+- Decimal formatting of numbers directly into output buffers.
 
 -----------------------------------------------------------------------------------------
 */
@@ -45,34 +37,14 @@ char *cloneString(char *s);
 char *trimFromLeft(char *s);
 
 /**
- * @brief Converts a decimal integer to its octal representation.
- *
- * This function takes a decimal number and returns its octal equivalent as a string.
- *
- * @param num The decimal number to be converted.
- * @return char* A pointer to a string containing the octal representation of the number.
- */
-
-char *numToBin(int num);
-
-/**
- * @brief Converts a 15-bit binary word to its octal representation.
- *
- * This function converts a 15-bit binary word into an octal word, breaking it into groups of 3 bits
- * and mapping them to corresponding octal digits.
- *
- * @param word A pointer to a BinaryWord structure representing the binary digits.
- * @return OctalWord* A pointer to an OctalWord structure containing the octal representation.
- */
-OctalWord *convertBinaryWordToOctal(BinaryWord *word);
-
-/**
- * @brief Converts a 3-bit binary string to its octal equivalent.
+ * @brief Writes an unsigned number in decimal, padded with leading zeros.
  *
- * This function takes a 3-character binary string (e.g., "101") and converts it to the corresponding
- * octal value.
+ * This function writes the digits of the number without a null terminator, so it can be
+ * used to build output text directly inside a larger buffer.
  *
- * @param binaryStr A 3-character binary string (e.g., "101").
- * @return unsigned The octal value of the binary string.
+ * @param dst The buffer to write into (at least MAX_DECIMAL_DIGITS characters).
+ * @param value The number to write.
+ * @param minDigits The minimal number of digits to write.
+ * @return int The number of characters written.
  */
-unsigned binaryStringToOctalNumber(char binaryStr[3]);
\ No newline at end of file
+int formatDecimal(char *dst, unsigned value, int minDigits);
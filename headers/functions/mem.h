@@ -21,8 +21,9 @@ In the second pass, the functions build the final memory image, which is later e
  * This function increments the data counter (DC) by the given number of memory addresses.
  *
  * @param amount The amount to increase the data counter by.
+ * @return True if the code and data still fit in the memory, False (after reporting an error) otherwise.
  */
-void increaseDataCounter(int amount);
+Bool increaseDataCounter(int amount);
 
 /**
  * @brief Increases the instruction counter by the specified amount.
@@ -30,8 +31,9 @@ void increaseDataCounter(int amount);
  * This function increments the instruction counter (IC) by the given number of memory addresses.
  *
  * @param amount The amount to increase the instruction counter by.
+ * @return True if the code and data still fit in the memory, False (after reporting an error) otherwise.
  */
-void increaseInstructionCounter(int amount);
+Bool increaseInstructionCounter(int amount);
 
 /**
  * @brief Allocates memory for the final memory image.
@@ -50,26 +52,30 @@ void allocMemoryImg();
 void resetMemoryCounters();
 
 /**
- * @brief Converts a binary word string to a `BinaryWord` structure.
+ * @brief Returns a buffer size large enough for the whole .ob file text.
  *
- * This function takes a string representation of a binary word and converts it into
- * a `BinaryWord` structure. The data type parameter specifies whether the word belongs
- * to the instruction or data part of the memory image.
+ * @return size_t The maximal length of the .ob file text, its header line and its words lines.
+ */
+size_t getMemoryImageTextMaxLength();
+
+/**
+ * @brief Formats the first line of the .ob file, the code and data sections sizes.
  *
- * @param s The binary word string to convert.
- * @param type The data type (instruction or data).
+ * @param dst A buffer of at least OB_HEADER_MAX_LEN characters.
+ * @return size_t The number of characters written, no null terminator is written.
  */
-void wordStringToWordObj(char *s, DataType type);
+size_t formatMemoryImageHeader(char *dst);
 
 /**
- * @brief Writes the memory image to the specified object (.ob) file.
+ * @brief Formats the address and octal word line of every word of the memory image.
  *
- * This function generates the .ob memory image by writing each word in the memory image
- * (code and data) to the specified file in the required format.
+ * Each word's octal digits are copied from a precomputed lookup table of all
+ * 15-bit values, so no per digit conversion is done.
  *
- * @param fp The file pointer to the .ob file.
+ * @param dst A buffer of at least `getMemoryImageTextMaxLength()` characters.
+ * @return size_t The number of characters written, no null terminator is written.
  */
-void writeMemoryImageToObFile(FILE *fp);
+size_t formatMemoryImageWords(char *dst);
 
 /**
  * @brief Prints the memory image in the required object file format.
@@ -96,22 +102,22 @@ void printWordBinary(unsigned index);
 /**
  * @brief Adds a word to the code segment of the memory image.
  *
- * This function adds a word to the code image by converting a string representation
- * of the word and appending it to the code image.
+ * This function stores an encoded word at the current instruction counter position
+ * and advances the counter.
  *
- * @param s The string representing the word to add.
+ * @param word The encoded word to add.
  */
-void addWordToCodeImage(char *s);
+void addWordToCodeImage(Word word);
 
 /**
  * @brief Adds a word to the data segment of the memory image.
  *
- * This function adds a word to the data image by converting a string representation
- * of the word and appending it to the data image.
+ * This function stores an encoded word at the current data counter position
+ * and advances the counter.
  *
- * @param s The string representing the word to add.
+ * @param word The encoded word to add.
  */
-void addWordToDataImage(char *s);
+void addWordToDataImage(Word word);
 
 /**
  * @brief Adds a word to either the code or data image based on the data type.
@@ -158,3 +164,20 @@ unsigned getICF();
  * @return unsigned The final value of the data counter after processing.
  */
 unsigned getDCF();
+
+/**
+ * @brief Retrieves the memory image, from MEMORY_START up to the final data counter (DCF).
+ *
+ * @return const Word* The words of the memory image, valid until it is allocated again.
+ */
+const Word *getMemoryImage();
+
+/**
+ * @brief Retrieves the line of the expanded file (.am) that the instruction at an address was assembled from.
+ *
+ * The lines are recorded by the first pass, as it counts the instructions of the current source file.
+ *
+ * @param address The address the instruction starts at.
+ * @return unsigned The line number, or 0 if no instruction starts at the address.
+ */
+unsigned getInstructionLine(unsigned address);
@@ -10,7 +10,14 @@ Key Functions:
 - **parseSourceFile:** Reads the source file line by line and calls `parseMacros` to handle
   macro definitions and invocations.
 - **parseMacros:** Processes macros, either by storing macro definitions or replacing
-  macro invocations with the corresponding content.
+  macro invocations with the corresponding content, and include directives.
+
+An included file (.include "file") is parsed once per run: its expanded text and macros
+are cached, and every following include of it, from any source file, reuses them.
+
+Each line written to the expanded file is mapped to the line of the source file it was written
+for (the line of the macro use or of the include directive for expanded lines), so the expanded
+lines the passes count can be reported as source lines (--profile).
 
 By the end of the pre-assembly phase, the source file is processed and expanded with macro
 definitions replaced, ensuring that the rest of the assembly process can proceed without needing
@@ -27,26 +34,44 @@ extern State (*globalState)();
 /**
  * parseMacros
  * -----------
- * Processes macro declarations and invocations in the source file.
- * This function checks for macros, stores macro definitions, and replaces macro
- * invocations with their corresponding content.
+ * Processes macro declarations, macro invocations and include directives in the source file.
+ * This function checks for macros, stores macro definitions in memory, and replaces macro
+ * invocations and included files with their corresponding content.
  *
  * Parameters:
  * - line: The current line from the source file being processed.
  * - token: The first token in the line, which could be a macro name or instruction.
- * - src: The source file being parsed.
- * - target: The output file where processed lines are written.
  */
-void parseMacros(char *line, char *token, FILE *src, FILE *target);
+void parseMacros(char *line, char *token);
 
 /**
  * parseSourceFile
  * ---------------
- * Reads through the entire source file and processes each line, checking for macros.
- * It writes the processed content, with macros expanded, into the target file.
+ * Reads through the entire source file and processes each line, checking for macros and include directives.
+ * It writes the processed content, with macros and included files expanded, into the target file.
  *
  * Parameters:
  * - src: The source file being parsed.
  * - target: The target file where the processed content will be written.
  */
 void parseSourceFile(FILE *src, FILE *target);
+
+/**
+ * getSourceLine
+ * -------------
+ * Finds the line of the source file (.as) a line of the expanded file (.am) of the current source file was written for.
+ *
+ * Parameters:
+ * - expandedLine: The number of the line in the expanded file, as counted by getCurrentLineNumber in the passes.
+ *
+ * Returns:
+ * - unsigned: The number of the line in the source file, or 0 if it is unknown.
+ */
+unsigned getSourceLine(unsigned expandedLine);
+
+/**
+ * freeIncludeCache
+ * ----------------
+ * Frees the cache of included files that is shared by all the source files of the run, and the source lines map.
+ */
+void freeIncludeCache();
@@ -0,0 +1,23 @@
+
+/*
+-----------------------------------------------------------------------------------------
+--------------------------- profiler.c General Overview: ---------------------------
+-----------------------------------------------------------------------------------------
+This module reports the profile of an emulated program (--profile). While the program runs, the
+emulator counts in a Profile the executions of the instruction at each address, the executions of
+each opcode, and the jumps taken back to an address that is not after them (the iterations of loops).
+After the program ended, the opcodes histogram, the hot addresses and the hot loops are printed.
+The addresses of a program that was just assembled are reported with the lines of its source file
+(.as): the first pass records the line of the expanded file (.am) each instruction starts at, and
+the pre-assembler maps each line of the expanded file to the source line it was written for.
+-----------------------------------------------------------------------------------------
+*/
+
+/**
+ * @brief Prints the profile of a program that ran: its opcodes histogram, hot addresses and hot loops.
+ *
+ * @param machine The machine the program ran on, with its profile.
+ * @param name The name of the program in the report.
+ * @param hasSourceLines True if the program is the source file that was just assembled, so its addresses have source lines.
+ */
+void printProfile(Machine *machine, char *name, Bool hasSourceLines);
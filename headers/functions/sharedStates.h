@@ -17,6 +17,9 @@ at any given time. It provides functionality to track:
 3. **The current line number**: This keeps track of the line number within the source file, which is useful
    for error reporting and managing the assembler's progress through the file.
 
+4. **The command line options**: The settings that apply to all the source files of the run, such as the
+   maximal number of errors reported for a file (--max-errors) and how much is printed (--verbosity).
+
 By using getter and setter functions, the state management is encapsulated within the module, and the rest
 of the program interacts with these global variables exclusively through these functions.
 
@@ -64,6 +67,16 @@ void setFileNamePath(char *s);
  */
 char *getFileNamePath();
 
+/**
+ * peekFileNamePath
+ * ----------------
+ * Retrieves the current file path without copying it, the returned string must not be changed or freed.
+ *
+ * Returns:
+ * - char*: The current file path.
+ */
+char *peekFileNamePath();
+
 /**
  * resetCurrentLineNumber
  * ----------------------
@@ -71,6 +84,16 @@ char *getFileNamePath();
  */
 void resetCurrentLineNumber();
 
+/**
+ * setCurrentLineNumber
+ * --------------------
+ * Sets the current line number, used to return to a file after an included file was processed.
+ *
+ * Parameters:
+ * - lineNumber: The new current line number.
+ */
+void setCurrentLineNumber(int lineNumber);
+
 /**
  * increaseCurrentLineNumber
  * -------------------------
@@ -86,4 +109,204 @@ void increaseCurrentLineNumber();
  * Returns:
  * - int: The current line number.
  */
-int getCurrentLineNumber();
\ No newline at end of file
+int getCurrentLineNumber();
+
+/**
+ * setMaxErrors
+ * ------------
+ * Sets the number of errors reported for a file before its processing is stopped (--max-errors).
+ *
+ * Parameters:
+ * - limit: The number of errors, 0 for no limit.
+ */
+void setMaxErrors(int limit);
+
+/**
+ * getMaxErrors
+ * ------------
+ * Retrieves the number of errors reported for a file before its processing is stopped.
+ *
+ * Returns:
+ * - int: The number of errors, 0 for no limit.
+ */
+int getMaxErrors();
+
+/**
+ * setDiagnosticsFormat
+ * --------------------
+ * Sets the format the diagnostics are written to stderr in (--diagnostics).
+ *
+ * Parameters:
+ * - format: The text banners, or JSON lines.
+ */
+void setDiagnosticsFormat(DiagnosticsFormat format);
+
+/**
+ * getDiagnosticsFormat
+ * --------------------
+ * Retrieves the format the diagnostics are written to stderr in.
+ *
+ * Returns:
+ * - DiagnosticsFormat: The text banners, or JSON lines.
+ */
+DiagnosticsFormat getDiagnosticsFormat();
+
+/**
+ * setStatsEnabled
+ * ---------------
+ * Sets whether the times and counters of the phases are reported (--stats).
+ *
+ * Parameters:
+ * - isEnabled: True to report them.
+ */
+void setStatsEnabled(Bool isEnabled);
+
+/**
+ * isStatsEnabled
+ * --------------
+ * Checks whether the times and counters of the phases are reported.
+ *
+ * Returns:
+ * - Bool: True if --stats was given.
+ */
+Bool isStatsEnabled();
+
+/**
+ * setTraceFile
+ * ------------
+ * Sets the file the trace events of the run are written to (--trace).
+ *
+ * Parameters:
+ * - fileName: The name of the file, that stays valid for the whole run (an argument of the program).
+ */
+void setTraceFile(char *fileName);
+
+/**
+ * getTraceFile
+ * ------------
+ * Retrieves the file the trace events of the run are written to.
+ *
+ * Returns:
+ * - char*: The name of the file, or NULL if --trace was not given.
+ */
+char *getTraceFile();
+
+/**
+ * setVerbosity
+ * ------------
+ * Sets how much is printed to stdout (--verbosity).
+ *
+ * Parameters:
+ * - level: Nothing, one summary line per file, or also the banners and the tables.
+ */
+void setVerbosity(Verbosity level);
+
+/**
+ * isVerbose
+ * ---------
+ * Checks whether the output of a verbosity level is printed, before it is formatted.
+ *
+ * Returns:
+ * - Bool: True if --verbosity is at this level or above it.
+ */
+Bool isVerbose(Verbosity level);
+
+/**
+ * setRunEnabled
+ * -------------
+ * Sets whether each assembled program is run by the emulator after its files are exported (--run).
+ *
+ * Parameters:
+ * - isEnabled: True to run them.
+ */
+void setRunEnabled(Bool isEnabled);
+
+/**
+ * isRunEnabled
+ * ------------
+ * Checks whether each assembled program is run by the emulator.
+ *
+ * Returns:
+ * - Bool: True if --run was given.
+ */
+Bool isRunEnabled();
+
+/**
+ * setProfileEnabled
+ * -----------------
+ * Sets whether the instructions each emulated program executes are counted and reported (--profile).
+ *
+ * Parameters:
+ * - isEnabled: True to profile them.
+ */
+void setProfileEnabled(Bool isEnabled);
+
+/**
+ * isProfileEnabled
+ * ----------------
+ * Checks whether the emulated programs are profiled.
+ *
+ * Returns:
+ * - Bool: True if --profile was given.
+ */
+Bool isProfileEnabled();
+
+/**
+ * setBatchFile
+ * ------------
+ * Sets the list of the cases that are run in parallel by the emulator (--batch).
+ *
+ * Parameters:
+ * - fileName: The name of the list.
+ */
+void setBatchFile(char *fileName);
+
+/**
+ * getBatchFile
+ * ------------
+ * Retrieves the list of the cases that are run in parallel by the emulator.
+ *
+ * Returns:
+ * - char*: The name of the list, or NULL if --batch was not given.
+ */
+char *getBatchFile();
+
+/**
+ * setJobs
+ * -------
+ * Sets the number of threads that run the cases of the batch (--jobs).
+ *
+ * Parameters:
+ * - count: The number of threads.
+ */
+void setJobs(int count);
+
+/**
+ * getJobs
+ * -------
+ * Retrieves the number of threads that run the cases of the batch.
+ *
+ * Returns:
+ * - int: The number of threads, or 0 for one per processor.
+ */
+int getJobs();
+
+/**
+ * setMaxSteps
+ * -----------
+ * Sets the number of instructions an emulated program may execute before it is stopped (--max-steps).
+ *
+ * Parameters:
+ * - limit: The number of instructions.
+ */
+void setMaxSteps(unsigned long limit);
+
+/**
+ * getMaxSteps
+ * -----------
+ * Retrieves the number of instructions an emulated program may execute.
+ *
+ * Returns:
+ * - unsigned long: The number of instructions.
+ */
+unsigned long getMaxSteps();
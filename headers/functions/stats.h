@@ -0,0 +1,130 @@
+
+/*
+-----------------------------------------------------------------------------------------
+--------------------------- stats.c General Overview: ---------------------------
+-----------------------------------------------------------------------------------------
+This module collects the run statistics that are reported with the --stats option.
+Each phase of a source file (macro expansion, first pass, symbol values update, second pass
+and files export) is timed in wall clock time and in processor time, and the work done in the
+file is counted: lines, statements, words emitted, symbols, macro expansions and externals uses.
+The statistics of each file are printed after it was processed, and are added to the totals
+of the run, that are printed after the last file.
+When built with -DTRACK_ALLOCATIONS (make track), all the heap allocations are counted for the
+phase they are made in, and the memory in use and its peak are reported with the times.
+With the --trace option, a span for each file and each phase, and the sizes of the symbol table
+and of the memory image after each phase, are written to a Chrome trace event file. The cases
+of a --batch run are traced too, each on the trace thread of the worker that ran it.
+-----------------------------------------------------------------------------------------
+*/
+
+/**
+ * @brief Marks the start of the run, the times of the --trace events are relative to it.
+ */
+void startRunStats();
+
+/**
+ * @brief Marks the start of the processing of a source file, for its span in the --trace file.
+ *
+ * @param fileName The name of the source file, that must stay valid until flushFileStats.
+ */
+void startFileStats(char *fileName);
+
+/**
+ * @brief Starts timing a phase of the current source file.
+ *
+ * Nothing is timed unless --stats or --trace was given.
+ *
+ * @param phase The phase that starts.
+ */
+void startPhase(StatsPhase phase);
+
+/**
+ * @brief Stops timing the phase that was started last, and adds its times to the current source file.
+ *
+ * @param phase The phase that ends.
+ */
+void endPhase(StatsPhase phase);
+
+/**
+ * @brief Adds to a counter of the current source file.
+ *
+ * @param counter The counter.
+ * @param amount The amount to add.
+ */
+void countStat(StatsCounter counter, long amount);
+
+/**
+ * @brief Prints the statistics of the source file that was processed (with --stats),
+ * adds them to the totals of the run and clears them for the next file.
+ *
+ * @param fileName The name of the source file.
+ */
+void flushFileStats(char *fileName);
+
+/**
+ * @brief Prints the totals of all the source files of the run (with --stats).
+ */
+void printBatchStats();
+
+/**
+ * @brief Adds the span of a case of a --batch run to the trace (with --trace), on the trace thread of its worker.
+ *
+ * @param name The name of the case.
+ * @param program The .ob file of the case.
+ * @param start The time the case started at.
+ * @param end The time the case ended at.
+ * @param worker The index of the worker that ran the case.
+ */
+void traceBatchCase(char *name, char *program, struct timespec *start, struct timespec *end, int worker);
+
+/**
+ * @brief Writes the spans of the files and the phases, and the symbol table and memory image sizes,
+ * to the --trace file in the Chrome trace event format.
+ */
+void writeTraceFile();
+
+/**
+ * @brief Counts a block that was allocated in the current phase (with -DTRACK_ALLOCATIONS).
+ *
+ * @param bytes The size of the block.
+ */
+void countAllocation(size_t bytes);
+
+/**
+ * @brief Counts a block that was freed in the current phase (with -DTRACK_ALLOCATIONS).
+ *
+ * @param bytes The size of the block.
+ */
+void countFree(size_t bytes);
+
+/**
+ * @brief Starts or stops counting the allocations for the cases of a --batch run, apart from the source files (with -DTRACK_ALLOCATIONS).
+ *
+ * @param isCounted True while the cases run.
+ */
+void countCaseAllocations(Bool isCounted);
+
+/**
+ * @brief Prints the heap use of the cases of a --batch run (with -DTRACK_ALLOCATIONS, nothing otherwise).
+ */
+void printCaseAllocations();
+
+/**
+ * @brief Returns the number of allocations counted for the current source file (with -DTRACK_ALLOCATIONS, 0 otherwise).
+ */
+long getAllocationsCount();
+
+#ifdef TRACK_ALLOCATIONS
+/* The allocations of all the modules go through the tracked functions, that keep the size of each block before it */
+void *trackedMalloc(size_t size);
+void *trackedCalloc(size_t count, size_t size);
+void *trackedRealloc(void *block, size_t size);
+void trackedFree(void *block);
+char *trackedRealpath(const char *path, char *resolved);
+
+#define malloc(size) trackedMalloc(size)
+#define calloc(count, size) trackedCalloc(count, size)
+#define realloc(block, size) trackedRealloc(block, size)
+#define free(block) trackedFree(block)
+#define realpath(path, resolved) trackedRealpath(path, resolved)
+#endif
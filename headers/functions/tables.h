@@ -36,9 +36,9 @@ void updateExtPositionData(char *name, unsigned base, unsigned offset);
    @ Description: Updates the base and offset for an external symbol's position.
 */
 
-void freeTableItem(Item *item);
+void freeTableItem(Item *item, ItemType type);
 /* @ Function: freeTableItem
-   @ Description: Frees a table item and its linked list of items.
+   @ Description: Frees a table item and its linked list of items, including the bodies and templates of macro items.
 */
 
 void addExtListItem(char *name);
@@ -148,15 +148,15 @@ Item *getMacro(char *s);
    @ Returns: Pointer to the found macro or NULL if not found.
 */
 
-Item *addMacro(char *name, int start, int end);
+Item *addMacro(char *name, MacroData *data);
 /* @ Function: addMacro
-   @ Description: Adds a new macro to the macro table with its start and end positions.
+   @ Description: Adds a new macro to the macro table, taking ownership of its in memory body and compiled template.
    @ Returns: Pointer to the newly added macro or NULL if the name is already in use.
 */
 
-Item *updateMacro(char *name, int start, int end);
+Item *updateMacro(char *name, MacroData *data);
 /* @ Function: updateMacro
-   @ Description: Updates the start and end positions of an existing macro.
+   @ Description: Replaces the body and template of an existing macro, freeing the previous ones.
    @ Returns: Pointer to the updated macro or NULL if not found.
 */
 
@@ -170,6 +170,22 @@ void updateFinalValueOfSingleItem(Item *item);
    @ Description: Updates the final value of a single symbol item based on its attributes.
 */
 
+void buildSymbolsSnapshot();
+/* @ Function: buildSymbolsSnapshot
+   @ Description: Builds the immutable array of all symbols sorted by address, used by all the symbol table exports.
+*/
+
+void freeSymbolsSnapshot();
+/* @ Function: freeSymbolsSnapshot
+   @ Description: Frees the symbols snapshot array.
+*/
+
+Item *findSymbolByAddress(unsigned address);
+/* @ Function: findSymbolByAddress
+   @ Description: Binary searches the snapshot for the code or data symbol that an address belongs to.
+   @ Returns: The symbol with the highest address lower or equal to the given one, or NULL if there is none.
+*/
+
 Bool areEntriesExist();
 /* @ Function: areEntriesExist
    @ Description: Checks if there are any entry symbols in the symbol table.
@@ -182,24 +198,28 @@ Bool areExternalsExist();
    @ Returns: True if external symbols exist, False otherwise.
 */
 
-void writeExternalsToFile(FILE *fp);
-/* @ Function: writeExternalsToFile
-   @ Description: Writes all external symbols and their positions to the specified file.
+Bool writeExternalsToBuffer(OutputBuffer *buffer);
+/* @ Function: writeExternalsToBuffer
+   @ Description: Writes all external symbols and their positions to the .ext output buffer.
+   @ Returns: False if the buffer could not grow, True otherwise.
 */
 
-void writeSingleExternal(FILE *fp, char *name, unsigned base, unsigned offset, ExtPositionData *next);
+Bool writeSingleExternal(OutputBuffer *buffer, char *name, unsigned base, unsigned offset, ExtPositionData *next);
 /* @ Function: writeSingleExternal
-   @ Description: Writes a single external symbol and its positions to the specified file.
+   @ Description: Writes a single external symbol and its positions to the output buffer.
+   @ Returns: False if the buffer could not grow, True otherwise.
 */
 
-void writeEntriesToFile(FILE *fp);
-/* @ Function: writeEntriesToFile
-   @ Description: Writes all entry symbols and their final addresses to the specified file.
+Bool writeEntriesToBuffer(OutputBuffer *buffer);
+/* @ Function: writeEntriesToBuffer
+   @ Description: Writes all entry symbols and their final addresses to the .ent output buffer.
+   @ Returns: False if the buffer could not grow, True otherwise.
 */
 
-int writeSingleEntry(Item *item, FILE *fp, int count);
+Bool writeSingleEntry(Item *item, OutputBuffer *buffer);
 /* @ Function: writeSingleEntry
-   @ Description: Writes a single entry symbol and its final address to the specified file.
+   @ Description: Writes a single entry symbol and its final address to the output buffer.
+   @ Returns: False if the buffer could not grow, True otherwise.
 */
 
 void initTables();
@@ -212,14 +232,20 @@ void freeHashTable(ItemType type);
    @ Description: Frees all elements in the hash table (either symbol or macro table).
 */
 
+void printTablesHealth();
+/* @ Function: printTablesHealth
+   @ Description: Prints the lookups, hit ratio, probes, installs, longest chain and bucket occupancy histogram
+   of the macro and symbol tables over the run (part of the --stats report).
+*/
+
 void printMacroTable();
 /* @ Function: printMacroTable
-   @ Description: Prints the macro table, including macro names and their start and end positions.
+   @ Description: Prints the macro table, including macro names, parameter counts and the lines and length of their bodies.
 */
 
 int printMacroItem(Item *item);
 /* @ Function: printMacroItem
-   @ Description: Prints a single macro's name, start, and end positions.
+   @ Description: Prints a single macro's name, parameter count, and the lines and length of its body.
    @ Returns: Always returns 0.
 */
 
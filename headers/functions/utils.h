@@ -138,3 +138,10 @@ Bool verifyLabelNamingAndPrintErrors(char *s);
    @ Description: Verifies that the label name is valid and prints errors if not.
    @ Returns: True if the label name is valid, False otherwise.
 */
+
+size_t renderJsonString(char *dst, char *s);
+/* @ Function: renderJsonString
+   @ Description: Writes a string as a JSON string value, with its quotes and escapes. dst must have room for
+   JSON_ESCAPE_MAX_LEN characters for each character of s, and the quotes.
+   @ Returns: The number of characters written.
+*/
@@ -1,25 +1,6 @@
-
-
-/*Bit is is a special variable that we made to build with BinaryWord*/
-typedef struct
-{
-    unsigned int on : 1;
-} Bit;
-/*BinaryWord is a struct for holding memory and data image in memory format*/
-typedef struct
-{
-    Bit digit[BINARY_WORD_SIZE];
-} BinaryWord;
-
-/*Like BinaryWord, it represent a word with 5 hexa decimal characters in the order we will output to th .ob file*/
-typedef struct
-{
-    unsigned int _A : 4;
-    unsigned int _B : 4;
-    unsigned int _C : 4;
-    unsigned int _D : 4;
-    unsigned int _E : 4;
-} OctalWord;
+/*Word is a single machine word of the code and data images. The 15 bits of the word are packed into the
+low bits of an unsigned short (bit 14 is the most significant bit), and are written and read with shifts and masks*/
+typedef unsigned short Word;
 
 /*AddrMethodsOptions is a struct for addressing mehod, each member represent operand addressing method
 and the value can be 0 or 1 and the meaning is to  tell us if the addressing method is legal/optional
@@ -56,12 +37,35 @@ typedef enum
     Data
 } DataType;
 
-/* MacroData is a struct that holds the additional unique data fields of each macro item in the macros hash table. The start member represents the starting index of the content of the macro in the source (.as) files
- The end member is the same as start, but for the ending of the macro content*/
+/* MacroSegment is a single piece of a compiled macro template. A literal segment (param is MACRO_LITERAL_SEGMENT) is the run of
+ length characters that starts at index start of the macro body, any other segment is replaced by the argument at index param of the macro use*/
 typedef struct
 {
     int start;
-    int end;
+    int length;
+    int param;
+} MacroSegment;
+
+/* MacroData is a struct that holds the additional unique data fields of each macro item in the macros hash table. The body member holds the content lines
+ of the macro, copied once from the source (.as) file when the macro is defined, so each use of the macro is a single copy of the body.
+ The length member is the number of characters in the body and the lines member is the number of lines in it.
+ The segments member is the template the body is compiled into when the macro is defined: the literal runs of the body and the slots of
+ its params parameters (named by paramNames), so expanding the macro is writing the segments one after the other.
+ The flattenState member tells whether the uses of other macros inside the body were already expanded into the body and template.
+ The isShared member is set when the body, parameter names and segments belong to the included files cache and not to the macro item,
+ and the file member is the included file the macro is defined in (NULL for a macro of the source file)*/
+typedef struct
+{
+    char *body;
+    int length;
+    int lines;
+    int params;
+    char (*paramNames)[MAX_LABEL_LEN];
+    MacroSegment *segments;
+    int segmentCount;
+    MacroFlattenState flattenState;
+    Bool isShared;
+    struct IncludedFile *file;
 } MacroData;
 
 /* ExtPositionData is the nested singly linked list element in the ExtListItem that we just mentioned above.*/
@@ -121,10 +125,225 @@ typedef struct Item
     struct Item *next;
 } Item;
 
-/* Struct to store log file information for each fileName */
-typedef struct LogFiles
+/* Diagnostic is a single reported error, warning or failure, kept until the source file is done.
+ The code is the Error or Warning value, fileId is the index of the name of the file it is about,
+ line is the line it is reported on and argId is the index of the file name the message refers to */
+typedef struct
+{
+    int code;
+    DiagnosticSeverity severity;
+    int fileId;
+    int line;
+    int argId;
+} Diagnostic;
+
+/* DiagnosticMessage is an entry of the message catalog the diagnostics are rendered from, name is the name of the code in its enum */
+typedef struct
+{
+    int code;
+    char *name;
+    DiagnosticSeverity severity;
+    char *message;
+} DiagnosticMessage;
+
+/* OutputBuffer is a growable in memory buffer that the content of an output file (.ob, .ent, .ext)
+is built in before the file is written to the disk in a single vectored write */
+typedef struct
+{
+    char *data;
+    size_t length;
+    size_t capacity;
+} OutputBuffer;
+
+/* MacroDefinition is a macro that was defined in an included file, kept in the included files cache with its name */
+typedef struct
+{
+    char *name;
+    MacroData data;
+} MacroDefinition;
+
+/* IncludePoint is the position (offset) in the expanded text of an included file where another file (file) is included */
+typedef struct IncludePoint
+{
+    size_t offset;
+    struct IncludedFile *file;
+} IncludePoint;
+
+/* IncludedFile is an entry of the included files cache, that is kept across all the source files of a run.
+ An included file is parsed only once: its expanded text (without the files it includes, that are marked by the include points)
+ and the macros it defines are kept, and each following include of it reuses them.
+ The path is the resolved path of the file, and the name is the path it was included by, that the errors inside it are reported with.
+ The registeredUnit and emittedUnit members are the last source file the macros of the file were added to and the text was written to,
+ so a file is included at most once in each source file*/
+typedef struct IncludedFile
+{
+    char *path;
+    char *name;
+    OutputBuffer text;
+    MacroDefinition *macros;
+    int macroCount;
+    int macroCapacity;
+    IncludePoint *includes;
+    int includeCount;
+    int includeCapacity;
+    unsigned registeredUnit;
+    unsigned emittedUnit;
+    Bool isParsed;
+    Bool isFailed;
+    struct IncludedFile *next;
+} IncludedFile;
+
+/* TableHealth is how well the hash table of an ItemType works over the run: the lookups, the items compared by them (probes),
+ the installs, and the length of the chains of the table at the end of each file (sampledTables of them), as the longest chain
+ and as a histogram of the number of buckets that held each number of items (the last entry counts the longer chains too) */
+typedef struct
+{
+    long lookups;
+    long hits;
+    long probes;
+    long installs;
+    long sampledTables;
+    int maxChainLength;
+    long chainLengths[TABLE_HEALTH_HISTOGRAM_SIZE];
+} TableHealth;
+
+/* DecodedInstruction is an instruction of the emulated memory, decoded once before the program runs:
+ its opcode (an Opcode), the kind of each operand (an OperandKind), its size in words, and the value of each
+ operand - the immediate value, the address of a direct operand, or the register of a register or indirect operand.
+ When no operand is indirect or external, isResolved is set and the words the operands refer to are known before
+ the instruction runs: srcCell and dstCell are their offsets (in words) from the start of the Machine, so they stay
+ valid when the machine is copied */
+typedef struct
+{
+    unsigned char opcode;
+    unsigned char srcKind;
+    unsigned char dstKind;
+    unsigned char size;
+    Word src;
+    Word dst;
+    unsigned short srcCell;
+    unsigned short dstCell;
+    unsigned char isResolved;
+} DecodedInstruction;
+
+/* Profile counts what an emulated program executed (--profile): how many times the instruction at each address ran,
+ how many times a jump at each address was taken back to an address that is not after it (an iteration of a loop),
+ and how many times each opcode ran */
+typedef struct
+{
+    unsigned long executions[RAM_MEMORY_SIZE];
+    unsigned long backJumps[RAM_MEMORY_SIZE];
+    unsigned long opcodes[OP_SIZE];
+} Profile;
+
+/* Machine is the state of an emulated program (--run). The code is loaded from MEMORY_START up to codeEnd and the data
+ up to imageEnd, and the stack grows down from the end of the memory. decoded holds the instruction that starts at each
+ address of the code. The output of prn is kept in output and written to outputFile (if it is not NULL), and red reads
+ the characters of input. The executed instructions are counted in profile, unless it is NULL. dirtyPages marks the
+ pages of memory (and of decoded) that changed since the machine was snapshotted to, or restored from, snapshot */
+typedef struct
+{
+    Word registers[REGS_SIZE];
+    Word psw;
+    unsigned pc;
+    unsigned sp;
+    unsigned codeEnd;
+    unsigned imageEnd;
+    unsigned long steps;
+    unsigned long maxSteps;
+    MachineStatus status;
+    Word memory[RAM_MEMORY_SIZE];
+    DecodedInstruction decoded[RAM_MEMORY_SIZE];
+    OutputBuffer output;
+    FILE *outputFile;
+    const char *input;
+    size_t inputLength;
+    size_t inputPosition;
+    Profile *profile;
+    unsigned char dirtyPages[EMULATOR_PAGES_COUNT];
+    const struct MachineSnapshot *snapshot;
+} Machine;
+
+/* MachineSnapshot is a copy of the full state of a machine - its registers, program status word, memory, decoded
+ instructions, input position and output - that restoreMachine brings a machine back to. state.output is its own copy */
+typedef struct MachineSnapshot
+{
+    Machine state;
+} MachineSnapshot;
+
+/* BatchCase is a case of a --batch list: a .ob program, the input its red instructions read and the line of the list,
+ and the result of its run - whether the program was loaded, how it ended, the times it started and ended at, the worker
+ that ran it, and where its output is in the output of that worker */
+typedef struct
+{
+    char *program;
+    char *input;
+    size_t inputLength;
+    int line;
+    Bool isLoaded;
+    MachineStatus status;
+    unsigned pc;
+    unsigned long steps;
+    struct timespec start;
+    struct timespec end;
+    int worker;
+    size_t outputOffset;
+    size_t outputLength;
+} BatchCase;
+
+/* BatchWorker is a thread of a --batch run. Its queue holds the positions from begin up to end of the run order,
+ the worker takes them from begin and the other workers steal them from end, under lock. isStarted is set when its
+ thread was started. machine and snapshot come
+ from the pools of the run: program is the program the snapshot was loaded from (NULL before the first one), and
+ isProgramLoaded whether it could be loaded. output holds the outputs of the cases the worker ran, one after the other */
+typedef struct
+{
+    pthread_t thread;
+    Bool isStarted;
+    pthread_mutex_t lock;
+    long begin;
+    long end;
+    long steals;
+    Machine *machine;
+    MachineSnapshot *snapshot;
+    char *program;
+    Bool isProgramLoaded;
+    OutputBuffer output;
+} BatchWorker;
+
+/* PhaseTimes is the wall clock time and the processor time a phase took, in seconds */
+typedef struct
+{
+    double wall;
+    double cpu;
+} PhaseTimes;
+
+/* PhaseAllocations is the heap use of a phase, counted when built with -DTRACK_ALLOCATIONS:
+ the number of allocations it made, the bytes they took, and the bytes it freed */
+typedef struct
+{
+    long allocations;
+    long bytes;
+    long freedBytes;
+} PhaseAllocations;
+
+/* RunStats is what --stats reports for a source file, or for all the source files of the run (filesCount of them).
+ The last entry of allocations is the heap use outside the timed phases, and peakLiveBytes is the most heap memory that was in use at once */
+typedef struct
+{
+    PhaseTimes phases[STATS_PHASES_COUNT];
+    long counters[STATS_COUNTERS_COUNT];
+    PhaseAllocations allocations[STATS_PHASES_COUNT + 1];
+    long peakLiveBytes;
+    int filesCount;
+} RunStats;
+
+/* AllocationHeader is kept before each tracked block (-DTRACK_ALLOCATIONS) with the size of the block,
+ its other members only make the block after it aligned for any type */
+typedef union
 {
-    char fileName[MAX_FILENAME_LEN];
-    FILE *warningsFile;
-    FILE *errorsFile;
-} LogFiles;
\ No newline at end of file
+    size_t size;
+    long integer;
+    long double real;
+    void *pointer;
+} AllocationHeader;
@@ -1,5 +1,16 @@
 
 #define BINARY_WORD_SIZE 15
+#define WORD_MASK ((1 << BINARY_WORD_SIZE) - 1)
+#define OCTAL_DIGIT_SIZE 3
+#define OCTAL_DIGITS_IN_WORD (BINARY_WORD_SIZE / OCTAL_DIGIT_SIZE)
+#define MAX_DECIMAL_DIGITS 10
+#define OB_ADDRESS_MIN_DIGITS 4
+/* Longest .ob line: address, space, octal word and a newline */
+#define OB_LINE_MAX_LEN (MAX_DECIMAL_DIGITS + 1 + OCTAL_DIGITS_IN_WORD + 1)
+/* Longest .ob header line: code size, space, data size and a newline */
+#define OB_HEADER_MAX_LEN (MAX_DECIMAL_DIGITS + 1 + MAX_DECIMAL_DIGITS + 1)
+/* Longest .ent / .ext line: symbol name, space, address and a newline */
+#define SYMBOL_LINE_MAX_LEN (MAX_LABEL_LEN + 1 + MAX_DECIMAL_DIGITS + 1)
 #define MEMORY_START 100
 #define REGS_SIZE 8
 #define OP_SIZE 16
@@ -7,6 +18,59 @@
 #define MAX_LABEL_LEN 31
 #define MAX_LINE_LEN 81
 #define MAX_FILENAME_LEN 256
+#define MAX_MACRO_PARAMS 10
+/* The param value of a macro template segment that is copied from the macro body */
+#define MACRO_LITERAL_SEGMENT -1
+/* Longest output file extension (".ent" / ".ext") including the null terminator */
+#define MAX_EXTENSION_LEN 5
+/* Suffix of the temporary file an output file is written to before it is renamed to its final name */
+#define TEMP_FILE_SUFFIX ".XXXXXX"
+#define OUTPUT_FILE_MODE 0666
+#define OUTPUT_FILE_MAX_PARTS 4
+#define OUTPUT_BUFFER_INITIAL_SIZE 256
+#define DIAGNOSTICS_INITIAL_SIZE 16
+#define DIAGNOSTICS_SEPARATOR "######################################################################"
+/* The characters of a rendered diagnostic besides its file names and message: the separators, the header text and the numbers */
+#define DIAGNOSTIC_TEXT_MAX_EXTRA_LEN (2 * sizeof(DIAGNOSTICS_SEPARATOR) + 128 + 2 * MAX_DECIMAL_DIGITS)
+#define ERRORS_LOG_SUFFIX ".errors.log"
+#define MAX_ERRORS_OPTION "--max-errors"
+#define DIAGNOSTICS_OPTION "--diagnostics"
+#define STATS_OPTION "--stats"
+#define VERBOSITY_OPTION "--verbosity"
+#define RUN_OPTION "--run"
+#define MAX_STEPS_OPTION "--max-steps"
+#define PROFILE_OPTION "--profile"
+#define BATCH_OPTION "--batch"
+#define JOBS_OPTION "--jobs"
+#define OB_EXTENSION ".ob"
+/* The number of instructions an emulated program may execute before it is stopped (--max-steps) */
+#define EMULATOR_DEFAULT_MAX_STEPS 1000000000UL
+/* The output of an emulated program is written to stdout when it grows past this size, and when the program ends */
+#define EMULATOR_OUTPUT_FLUSH_SIZE 65536
+/* The bits of an immediate operand word above the A,R,E bits */
+#define IMMEDIATE_VALUE_BITS 12
+/* The zero flag of the program status word, set by cmp and tested by bne */
+#define PSW_ZERO 0x1
+/* The memory of an emulated machine is tracked in pages of this many words, a restore copies only the pages written since the snapshot */
+#define EMULATOR_PAGE_WORDS 64
+#define EMULATOR_PAGES_COUNT (RAM_MEMORY_SIZE / EMULATOR_PAGE_WORDS)
+/* The number of rows of the hot addresses and of the hot loops tables of --profile */
+#define PROFILE_TOP_ADDRESSES 10
+#define PROFILE_TOP_LOOPS 5
+#define STATS_PHASES_COUNT 5
+#define STATS_COUNTERS_COUNT 6
+#define TABLE_HEALTH_HISTOGRAM_SIZE 8
+#define TRACE_OPTION "--trace"
+#define TRACE_PROCESS_ID 1
+#define TRACE_WORKER_ID 0
+/* The trace thread of the --batch worker i is TRACE_WORKER_ID + 1 + i */
+/* The characters of a trace event besides its escaped strings */
+#define TRACE_EVENT_MAX_EXTRA_LEN 256
+/* The longest JSON text a character can take ("\u001f") */
+#define JSON_ESCAPE_MAX_LEN 6
+/* The characters of a JSON diagnostic besides its escaped strings: the member names, the punctuation and the numbers */
+#define JSON_DIAGNOSTIC_MAX_EXTRA_LEN (96 + MAX_DECIMAL_DIGITS)
+#define WARNINGS_LOG_SUFFIX ".warnings.log"
 
 /* Hash Table Hashsize (Result is currently 64)  */
 #define HASHSIZE ((RAM_MEMORY_SIZE / (MAX_LABEL_LEN + 1)) / 4)
@@ -34,6 +98,7 @@
 #define STRING ".string"
 #define ENTRY ".entry"
 #define EXTERNAL ".extern"
+#define INCLUDE ".include"
 /* convert the instructions to numbers*/
 #define _TYPE_DATA 11
 #define _TYPE_STRING 22
@@ -73,7 +73,13 @@ typedef enum
     emptyStringDeclatretion,
     emptyLabelDecleration,
     undefinedLabelDeclaretion,
-    registeryIndexOperandTypeIfOutOfAllowedRegisteriesRange
+    registeryIndexOperandTypeIfOutOfAllowedRegisteriesRange,
+    illegalMacroParameterName,
+    macroArgumentsCountMismatch,
+    macroRecursiveUse,
+    imageExceedsMemorySize,
+    expandedLineTooLong,
+    fileCouldNotBeCreated
 
 } Error;
 
@@ -88,6 +94,106 @@ typedef enum
 
 } Warning;
 
+/* The kind of a reported diagnostic, each kind has its own format and log file */
+typedef enum
+{
+    errorDiagnostic,
+    warningDiagnostic,
+    failureDiagnostic
+} DiagnosticSeverity;
+
+/* The format diagnostics are written to stderr in: the text banners, or one JSON object per line (--diagnostics=json) */
+typedef enum
+{
+    textDiagnostics,
+    jsonDiagnostics
+} DiagnosticsFormat;
+
+/* How much is printed to stdout (--verbosity): nothing, one summary line per file, or also the banners and the tables */
+typedef enum
+{
+    quietVerbosity,
+    normalVerbosity,
+    debugVerbosity
+} Verbosity;
+
+/* The opcodes of the operations, in the order of the operations table. undecodedOpcode marks
+ an address of the emulated memory that was not decoded as an instruction yet (--run) */
+typedef enum
+{
+    movOpcode,
+    cmpOpcode,
+    addOpcode,
+    subOpcode,
+    leaOpcode,
+    clrOpcode,
+    notOpcode,
+    incOpcode,
+    decOpcode,
+    jmpOpcode,
+    bneOpcode,
+    redOpcode,
+    prnOpcode,
+    jsrOpcode,
+    rtsOpcode,
+    stopOpcode,
+    undecodedOpcode
+} Opcode;
+
+/* The addressing method of an operand of a decoded instruction, externalOperand is a direct operand
+ of an external symbol, whose address is not known to the emulator */
+typedef enum
+{
+    noOperand,
+    immediateOperand,
+    directOperand,
+    indirectOperand,
+    registerOperand,
+    externalOperand
+} OperandKind;
+
+/* The state of an emulated program: running, ended by stop, or the fault that ended it */
+typedef enum
+{
+    machineRunning,
+    machineStopped,
+    illegalInstruction,
+    addressOutOfMemory,
+    externalReference,
+    stackOverflow,
+    stackUnderflow,
+    stepLimitReached
+} MachineStatus;
+
+/* The phases of a source file that are timed by --stats */
+typedef enum
+{
+    macroExpansionPhase,
+    firstPassPhase,
+    symbolValuesPhase,
+    secondPassPhase,
+    exportPhase
+} StatsPhase;
+
+/* The work counted for a source file by --stats */
+typedef enum
+{
+    linesCounter,
+    statementsCounter,
+    wordsCounter,
+    symbolsCounter,
+    macroExpansionsCounter,
+    externsCounter
+} StatsCounter;
+
+/* The flattening of a macro body: the uses of other macros inside it are expanded once, on the first use of the macro */
+typedef enum
+{
+    macroNotFlattened,
+    macroFlattening,
+    macroFlattened
+} MacroFlattenState;
+
 typedef enum
 {
     assemblyCodeFailedToCompile,
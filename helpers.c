@@ -9,18 +9,15 @@
  * - s: The string to be cloned.
  *
  * Returns:
- * - A pointer to the newly allocated string that is a copy of the input string.
- * - If the input string is empty, it returns an empty string.
+ * - A pointer to the newly allocated string that is a copy of the input string (an empty string is copied too),
+ *   that the caller frees, or NULL if the memory could not be allocated.
  */
 char *cloneString(char *s)
 {
-    char *copy;
-    if (!(*s))
-        return ""; /* Return empty string if input is empty */
-
-    /* Allocate memory for the copy and copy the string */
-    copy = (char *)calloc(strlen(s), sizeof(char *));
-    strcpy(copy, s);
+    /* Allocate memory for the copy (an empty string too, so every copy can be freed) and copy the string */
+    char *copy = (char *)malloc(strlen(s) + 1);
+    if (copy != NULL)
+        strcpy(copy, s);
     return copy;
 }
 
@@ -44,124 +41,35 @@ char *trimFromLeft(char *s)
 }
 
 /**
- * numToBin
- * ----
- * This function converts a decimal number to its binary representation as a 15-bit string.
- *
- * Parameters:
- * - num: The decimal number to be converted.
- *
- * Returns:
- * - A pointer to a string containing the 15-bit binary representation of the number.
- */
-char *numToBin(int num)
-{
-    /* Allocate memory for the binary string (15 characters + null terminator) */
-    int i = 0;
-    char *binaryString = (char *)calloc(BINARY_WORD_SIZE + 1, sizeof(char));
-
-    /* Mask the number to fit within 15 bits (two's complement) */
-    unsigned int maskedNum = num & ((1 << BINARY_WORD_SIZE) - 1); /* Keep only the last 15 bits */
-
-    /* Convert the masked number to a binary string (from right to left) */
-    for (i = BINARY_WORD_SIZE - 1; i >= 0; i--)
-    {
-        binaryString[i] = (maskedNum & 1) ? '1' : '0'; /* Get the last bit */
-        maskedNum >>= 1;                               /* Shift right */
-    }
-
-    return binaryString;
-}
-
-/**
- * convertBinaryWordToOctal
- * ------------
- * This function converts a 15-bit binary word to its octal equivalent, broken into groups of 3 bits.
+ * formatDecimal
+ * -------------
+ * Writes an unsigned number in decimal, padded with leading zeros to a minimal number of digits.
+ * No null terminator is written.
  *
  * Parameters:
- * - word: A pointer to a BinaryWord structure representing the binary digits.
+ * - dst: The buffer to write into.
+ * - value: The number to write.
+ * - minDigits: The minimal number of digits to write.
  *
  * Returns:
- * - A pointer to an OctalWord structure containing the octal representation of the binary word.
+ * - int: The number of characters written.
  */
-OctalWord *convertBinaryWordToOctal(BinaryWord *word)
+int formatDecimal(char *dst, unsigned value, int minDigits)
 {
-    int i = 0;
-    char octalDigits[4] = {0, 0, 0, '\0'};                        /* Temporary storage for 3 binary digits */
-    OctalWord *newOctal = (OctalWord *)malloc(sizeof(OctalWord)); /* Allocate memory for the new octal word */
+    char digits[MAX_DECIMAL_DIGITS];
+    int count = 0, i;
 
-    /* Iterate through the 15-bit binary word from right to left */
-    for (i = BINARY_WORD_SIZE - 1; i >= 0; i--)
+    do
     {
-        /* Store the current binary digit as either '1' or '0' */
-        octalDigits[i % 3] = word->digit[i].on ? '1' : '0';
-
-        /* Once we've filled 3 binary digits, convert them to an octal digit */
-        if (i % 3 == 0)
-        {
-            /* Convert the 3 binary digits to an octal number */
-            char octalValue = binaryStringToOctalNumber(octalDigits);
+        digits[count++] = (char)('0' + value % 10);
+        value /= 10;
+    } while (value);
 
-            /* Store the octal value in the appropriate field of the OctalWord */
-            switch (i)
-            {
-            case 12:
-                newOctal->_E = octalValue;
-                break;
-            case 9:
-                newOctal->_D = octalValue;
-                break;
-            case 6:
-                newOctal->_C = octalValue;
-                break;
-            case 3:
-                newOctal->_B = octalValue;
-                break;
-            case 0:
-                newOctal->_A = octalValue;
-                break;
-            default:
-                break;
-            }
+    while (count < minDigits)
+        digits[count++] = '0';
 
-            /* Reset the octalDigits array for the next group of 3 binary digits */
-            memset(octalDigits, 0, 3);
-        }
-    }
-
-    return newOctal;
-}
-
-/**
- * binaryStringToOctalNumber
- * -------------
- * This function converts a 3-bit binary string to its octal equivalent.
- *
- * Parameters:
- * - binaryStr: A 3-character binary string (e.g., "101").
- *
- * Returns:
- * - An unsigned integer representing the octal value of the binary string.
- */
-unsigned binaryStringToOctalNumber(char binaryStr[3])
-{
-    /* Compare the binary string to known 3-bit values and return the corresponding octal number */
-    if (!strcmp(binaryStr, "000"))
-        return 0;
-    if (!strcmp(binaryStr, "001"))
-        return 1;
-    if (!strcmp(binaryStr, "010"))
-        return 2;
-    if (!strcmp(binaryStr, "011"))
-        return 3;
-    if (!strcmp(binaryStr, "100"))
-        return 4;
-    if (!strcmp(binaryStr, "101"))
-        return 5;
-    if (!strcmp(binaryStr, "110"))
-        return 6;
-    if (!strcmp(binaryStr, "111"))
-        return 7;
+    for (i = 0; i < count; i++)
+        dst[i] = digits[count - 1 - i];
 
-    return 0;
+    return count;
 }
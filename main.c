@@ -2,7 +2,8 @@
 extern void resetMemoryCounters();
 extern void initTables();
 extern void exportFiles();
-extern void closeOpenLogFiles();
+extern void flushDiagnostics();
+extern void freeDiagnostics();
 extern void allocMemoryImg();
 extern void calcFinalAddrsCountersValues();
 extern void freeHashTable(ItemType type);
@@ -17,33 +18,207 @@ int main(int argc, char *argv[])
     return 0;
 }
 
+/*
+ * `parseOptionValue` reads the positive number of an option, given either as "--option=N" or as "--option N".
+ * It returns the number of extra arguments used for the value (0 or 1), or -1 if the value is missing or illegal.
+ */
+static int parseOptionValue(int argc, char *argv[], int i, int *value)
+{
+    char *text = strchr(argv[i], '='), *end;
+    long number;
+    int used = 0;
+
+    if (text != NULL)
+        text++;
+    else if (i + 1 < argc)
+    {
+        text = argv[i + 1];
+        used = 1;
+    }
+    else
+        return -1;
+
+    number = strtol(text, &end, 10);
+    if (*text == '\0' || *end != '\0' || number < 1 || number > INT_MAX)
+        return -1;
+
+    *value = (int)number;
+    return used;
+}
+
+/*
+ * `isOption` checks if an argument is the given option, alone or followed by "=value".
+ */
+static Bool isOption(char *argument, char *option)
+{
+    size_t length = strlen(option);
+    return !strncmp(argument, option, length) && (argument[length] == '\0' || argument[length] == '=') ? True : False;
+}
+
+/*
+ * `isObFile` checks if an argument is an object file (that ends with ".ob"), that is run by the emulator instead of being assembled.
+ */
+static Bool isObFile(char *argument)
+{
+    size_t length = strlen(argument), extensionLength = strlen(OB_EXTENSION);
+    return length > extensionLength && !strcmp(argument + length - extensionLength, OB_EXTENSION) ? True : False;
+}
+
+/*
+ * `handleOption` applies a command line option (an argument that starts with "--") to the settings of the run.
+ * It returns the number of extra arguments the option used. An unknown option or an illegal value ends the program.
+ */
+static int handleOption(int argc, char *argv[], int i)
+{
+    int used = -1, value = 0;
+    char *format = strchr(argv[i], '='); /* The value of an option given as "--option=value" */
+
+    if (isOption(argv[i], MAX_ERRORS_OPTION))
+    {
+        if ((used = parseOptionValue(argc, argv, i, &value)) != -1)
+            setMaxErrors(value);
+    }
+    else if (isOption(argv[i], TRACE_OPTION) && format != NULL && format[1] != '\0')
+    {
+        setTraceFile(format + 1);
+        used = 0;
+    }
+    else if (isOption(argv[i], VERBOSITY_OPTION) && format != NULL)
+    {
+        if (!strcmp(format + 1, "quiet") || !strcmp(format + 1, "normal") || !strcmp(format + 1, "debug"))
+        {
+            setVerbosity(!strcmp(format + 1, "quiet") ? quietVerbosity : !strcmp(format + 1, "debug") ? debugVerbosity : normalVerbosity);
+            used = 0;
+        }
+    }
+    else if (isOption(argv[i], MAX_STEPS_OPTION))
+    {
+        if ((used = parseOptionValue(argc, argv, i, &value)) != -1)
+            setMaxSteps((unsigned long)value);
+    }
+    else if (!strcmp(argv[i], RUN_OPTION))
+    {
+        setRunEnabled(True);
+        used = 0;
+    }
+    else if (isOption(argv[i], BATCH_OPTION) && format != NULL && format[1] != '\0')
+    {
+        setBatchFile(format + 1);
+        used = 0;
+    }
+    else if (isOption(argv[i], JOBS_OPTION))
+    {
+        if ((used = parseOptionValue(argc, argv, i, &value)) != -1)
+            setJobs(value);
+    }
+    else if (!strcmp(argv[i], PROFILE_OPTION))
+    {
+        setProfileEnabled(True);
+        used = 0;
+    }
+    else if (!strcmp(argv[i], STATS_OPTION))
+    {
+        setStatsEnabled(True);
+        used = 0;
+    }
+    else if (isOption(argv[i], DIAGNOSTICS_OPTION) && format != NULL)
+    {
+        /* The format is given only as "--diagnostics=FORMAT", so a source file is never taken as the format */
+        if (!strcmp(format + 1, "json") || !strcmp(format + 1, "text"))
+        {
+            setDiagnosticsFormat(!strcmp(format + 1, "json") ? jsonDiagnostics : textDiagnostics);
+            used = 0;
+        }
+    }
+
+    if (used == -1)
+    {
+        fprintf(stderr, "\n\nIllegal command line option %s!\nUsage: assembler [%s N] [%s=text|json] [%s=quiet|normal|debug] [%s] [%s N] [%s] [%s=LIST] [%s N] [%s] [%s=FILE] file|file.ob...\n\n", argv[i], MAX_ERRORS_OPTION, DIAGNOSTICS_OPTION, VERBOSITY_OPTION, RUN_OPTION, MAX_STEPS_OPTION, PROFILE_OPTION, BATCH_OPTION, JOBS_OPTION, STATS_OPTION, TRACE_OPTION);
+        exit(1);
+    }
+    return used;
+}
+
 int handleSourceFiles(int argc, char *argv[])
 {
     /*
      * `handleSourceFiles` processes all the files passed to the assembler via the command line.
+     * The options (arguments that start with "--") are applied first, to all the files.
      * The function checks if any files are provided; if not, it exits with an error message.
-     * It then iterates through each file and passes them to `handleSingleFile` for individual file processing.
+     * It then iterates through each file and passes them to `handleSingleFile` for individual file processing,
+     * or to `runObFile` if it is an object file (.ob) to run. The cases of a --batch list are run after the files.
      */
-    int filesCount = argc - 1; /* The number of source files passed (excluding the program name) */
-    int i = 1;                 /* Index to iterate through the files */
+    int filesCount = 0; /* The number of source files passed (excluding the program name and the options) */
+    int i;              /* Index to iterate through the arguments */
+
+    for (i = 1; i < argc; i++)
+    {
+        if (!strncmp(argv[i], "--", 2))
+            i += handleOption(argc, argv, i); /* Skip the value of the option */
+        else
+            filesCount++;
+    }
 
-    if (filesCount < 1)
+    if (filesCount < 1 && getBatchFile() == NULL)
     {
         /* If no files are provided, display an error and exit the program */
         fprintf(stderr, "\n\nNo source files were provided for the assembler!\n\n");
         exit(1);
     }
 
+    startRunStats(); /* The times of the --trace events are relative to this point */
+
     /* Loop through all the files passed via command-line arguments */
-    while (--argc)
+    for (i = 1; i < argc; i++)
     {
-        handleSingleFile(argv[i]);
-        i++;
+        if (!strncmp(argv[i], "--", 2))
+            i += handleOption(argc, argv, i);
+        else if (isObFile(argv[i]))
+            runObFile(argv[i]);
+        else
+            handleSingleFile(argv[i]);
     }
 
+    if (getBatchFile() != NULL)
+        runBatch(getBatchFile()); /* Run the cases of the list in parallel (--batch) */
+
+    printBatchStats();  /* Print the totals of the run (--stats) */
+    writeTraceFile();   /* Write the trace events of the run (--trace) */
+    freeIncludeCache(); /* Free the included files that were shared by the source files */
+    freeEmulatorInput(); /* Free the input of the emulated programs (--run) */
+    freeDiagnostics();  /* Free the diagnostics buffers */
+
     return 0;
 }
 
+/*
+ * `printFileSummary` prints the line that sums up a source file (unless --verbosity=quiet): whether it was
+ * assembled or the phase it failed in, and the number of its errors and warnings. A file that was assembled
+ * although errors were reported for it (like a macro name that is already in use) is not summed up as clean.
+ * It is called before the diagnostics of the file are flushed, while they can still be counted.
+ */
+static void printFileSummary(char *arg, char *failedPhase)
+{
+    int errors, warnings;
+
+    if (!isVerbose(normalVerbosity))
+        return;
+
+    errors = countDiagnostics(errorDiagnostic);
+    warnings = countDiagnostics(warningDiagnostic);
+    if (failedPhase == NULL && countDiagnostics(failureDiagnostic) > 0)
+        failedPhase = "file export"; /* An output file could not be created */
+
+    if (failedPhase == NULL && errors == 0)
+        printf("%s.as: assembled, %d warning%s\n", arg, warnings, warnings == 1 ? "" : "s");
+    else if (failedPhase == NULL)
+        printf("%s.as: assembled with errors, %d error%s, %d warning%s\n", arg,
+               errors, errors == 1 ? "" : "s", warnings, warnings == 1 ? "" : "s");
+    else
+        printf("%s.as: failed in the %s, %d error%s, %d warning%s\n", arg, failedPhase,
+               errors, errors == 1 ? "" : "s", warnings, warnings == 1 ? "" : "s");
+}
+
 extern void handleSingleFile(char *arg)
 {
     FILE *src = NULL, *target = NULL;
@@ -51,6 +226,7 @@ extern void handleSingleFile(char *arg)
     void (*setPath)(char *) = &setFileNamePath;
     void (*setState)(State) = &setGlobalState;
     State (*globalState)() = &getGlobalState;
+    char *failedPhase = NULL; /* The phase the file failed in, NULL if it was assembled */
 
     /*
      * The base file name is set by copying the original file name (arg) and appending ".as"
@@ -75,10 +251,10 @@ extern void handleSingleFile(char *arg)
 
     /*
      * Change the file extension from ".as" to ".am" to represent the expanded source file.
-     * This file will be generated by expanding macros in the source code.
+     * This file will be generated by expanding macros in the source code. The path stays
+     * the ".as" file until the macros are expanded, since the preassembler reads its lines.
      */
     fileName[strlen(fileName) - 1] = 'm'; /* Replace the 's' in ".as" with 'm' to make it ".am" */
-    (*setPath)(fileName);                 /* Update the path to point to the ".am" file */
 
     /*
      * Open the target file for writing the expanded source code (macro-expanded).
@@ -100,7 +276,8 @@ extern void handleSingleFile(char *arg)
      */
     else
     {
-        initTables(); /* Initialize tables used for storing macros, symbols, etc. */
+        startFileStats(arg); /* Start the span of the file (--trace) */
+        initTables();        /* Initialize tables used for storing macros, symbols, etc. */
 
         /*
          * Start by parsing and expanding macros in the source code.
@@ -109,8 +286,12 @@ extern void handleSingleFile(char *arg)
          */
         (*setState)(parsingMacros); /* Set the state to "parsing macros" */
         resetMemoryCounters();
+        startPhase(macroExpansionPhase);
         parseSourceFile(src, target); /* Parse the source file to handle macros */
-        printMacroTable();            /* Print the macro table after parsing */
+        endPhase(macroExpansionPhase);
+        (*setPath)(fileName);         /* Update the path to point to the ".am" file */
+        if (isVerbose(debugVerbosity))
+            printMacroTable();        /* Print the macro table after parsing */
         freeHashTable(Macro);         /* Free the memory used by the macro hash table */
 
         /*
@@ -119,8 +300,10 @@ extern void handleSingleFile(char *arg)
          */
         if ((*globalState)() == firstRun)
         {
-            rewind(target);            /* Reset the file pointer to the start of the target file */
+            rewind(target); /* Reset the file pointer to the start of the target file */
+            startPhase(firstPassPhase);
             parseAssemblyCode(target); /* Perform the first pass of assembly parsing */
+            endPhase(firstPassPhase);
 
             /*
              * If the first run completes without errors, the second run begins. In this run,
@@ -130,11 +313,16 @@ extern void handleSingleFile(char *arg)
             if ((*globalState)() == secondRun)
             {
                 calcFinalAddrsCountersValues(); /* Calculate final memory addresses */
+                startPhase(symbolValuesPhase);
                 updateFinalSymbolTableValues(); /* Update the symbol table with final values */
-                allocMemoryImg();               /* Allocate memory for the memory image */
-                printSymbolTable();             /* Print the symbol table */
-                rewind(target);                 /* Rewind the target file for another pass */
-                parseAssemblyCode(target);      /* Perform the second pass of assembly parsing */
+                endPhase(symbolValuesPhase);
+                allocMemoryImg();   /* Allocate memory for the memory image */
+                if (isVerbose(debugVerbosity))
+                    printSymbolTable(); /* Print the symbol table */
+                rewind(target);     /* Rewind the target file for another pass */
+                startPhase(secondPassPhase);
+                parseAssemblyCode(target); /* Perform the second pass of assembly parsing */
+                endPhase(secondPassPhase);
 
                 /*
                  * If no errors are encountered during the second run, we proceed to export the output files:
@@ -144,26 +332,44 @@ extern void handleSingleFile(char *arg)
                 {
                     fileName[strlen(fileName) - 3] = '\0'; /* Remove the ".am" extension */
                     (*setPath)(fileName);                  /* Set the path to the base file name */
-                    exportFiles();                         /* Export the files (.ob, .ent, .ext) */
+                    startPhase(exportPhase);
+                    exportFiles(); /* Export the files (.ob, .ent, .ext) */
+                    endPhase(exportPhase);
+                    if (isRunEnabled())
+                        runAssembledImage(fileName); /* Run the assembled program (--run) */
                 }
                 else
-                    printf("\nErrors encountered in second run, output files will not be created.\n");
+                {
+                    failedPhase = "second pass";
+                    if (isVerbose(debugVerbosity))
+                        printf("\nErrors encountered in second run, output files will not be created.\n");
+                }
             }
             else
-                printf("\nErrors encountered in first run, second run and file export will be skipped.\n");
+            {
+                failedPhase = "first pass";
+                if (isVerbose(debugVerbosity))
+                    printf("\nErrors encountered in first run, second run and file export will be skipped.\n");
+            }
 
             freeHashTable(Symbol); /* Free the symbol table after processing */
         }
         else
-            printf("\nMacro expansion for %s failed due to errors.\nMoving on to the next file.\n\n", fileName);
+        {
+            failedPhase = "macro expansion";
+            if (isVerbose(debugVerbosity))
+                printf("\nMacro expansion for %s failed due to errors.\nMoving on to the next file.\n\n", fileName);
+        }
 
         /*
          * Finally, free any allocated memory and close the files that were opened.
-         * The log files created during the process are also closed.
+         * The errors and warnings of the file are written to stderr and to the log files.
          */
         free(fileName);      /* Free the memory allocated for the file name */
         fclose(src);         /* Close the source file */
         fclose(target);      /* Close the target file */
-        closeOpenLogFiles(); /* Close any open log files */
+        printFileSummary(arg, failedPhase); /* Print the summary line of the file (--verbosity) */
+        flushDiagnostics(); /* Write the errors and warnings of the file to stderr and its log files */
+        flushFileStats(arg); /* Print the times and counters of the file (--stats) */
     }
 }
@@ -1,17 +1,18 @@
 #include "data.h"
 
-/* Global variables for binary and octal memory images */
-static BinaryWord *binaryImg = NULL;
-static OctalWord *OctalImg = NULL;
+/* Global memory image, the code image words followed by the data image words */
+static Word *memoryImg = NULL;
 unsigned static IC = MEMORY_START; /* Instruction Counter */
 unsigned static DC = 0;            /* Data Counter */
 unsigned static ICF = 0;           /* Instruction Counter Final */
 unsigned static DCF = 0;           /* Data Counter Final */
 
-/* External functions declared from other files */
-extern OctalWord *convertBinaryWordToOctal(BinaryWord *word);
-extern char *numToBin(int num);
-extern unsigned binaryStringToOctalNumber(char binaryStr[3]);
+/* Lookup table holding the five octal digits .ob text of every possible 15-bit word, filled on first use */
+static char octalWordText[WORD_MASK + 1][OCTAL_DIGITS_IN_WORD];
+static Bool isOctalWordTextReady = False;
+
+/* The line of the expanded file (.am) each instruction of the code image starts at, recorded by the first pass */
+static unsigned instructionLines[RAM_MEMORY_SIZE];
 
 /* Getter functions for DC, IC, ICF, and DCF */
 unsigned getDC() { return DC; }
@@ -19,6 +20,40 @@ unsigned getIC() { return IC; }
 unsigned getICF() { return ICF; }
 unsigned getDCF() { return DCF; }
 
+/**
+ * getMemoryImage
+ * --------------
+ * Retrieves the memory image, its first word is at MEMORY_START and it ends at the final data counter (DCF).
+ *
+ * Returns:
+ * - const Word*: The words of the memory image, valid until it is allocated again.
+ */
+const Word *getMemoryImage()
+{
+    return memoryImg;
+}
+
+/**
+ * isImageInMemory
+ * ---------------
+ * Checks if the code and data counted so far still fit in the memory of the machine, and reports
+ * an error on the line that first takes the image past its end.
+ *
+ * Parameters:
+ * - amount: The amount by which a counter was just increased.
+ *
+ * Returns:
+ * - Bool: True if the image fits in the memory, False otherwise.
+ */
+static Bool isImageInMemory(int amount)
+{
+    if (IC + DC <= RAM_MEMORY_SIZE)
+        return True;
+    if (IC + DC - amount <= RAM_MEMORY_SIZE)
+        reportError(imageExceedsMemorySize);
+    return False;
+}
+
 /**
  * increaseDataCounter
  * -------------------
@@ -26,60 +61,91 @@ unsigned getDCF() { return DCF; }
  *
  * Parameters:
  * - amount: The amount by which to increase the DC.
+ *
+ * Returns:
+ * - Bool: True if the image still fits in the memory, False otherwise.
  */
-void increaseDataCounter(int amount)
+Bool increaseDataCounter(int amount)
 {
     DC += amount;
+    return isImageInMemory(amount);
 }
 
 /**
  * increaseInstructionCounter
  * --------------------------
- * Increases the instruction counter (IC) by a specified amount.
+ * Increases the instruction counter (IC) by a specified amount, the size of the instruction
+ * that starts at it, and records the current line as the line of that instruction.
  *
  * Parameters:
  * - amount: The amount by which to increase the IC.
+ *
+ * Returns:
+ * - Bool: True if the image still fits in the memory, False otherwise.
  */
-void increaseInstructionCounter(int amount)
+Bool increaseInstructionCounter(int amount)
 {
+    if (IC < RAM_MEMORY_SIZE)
+        instructionLines[IC] = (unsigned)getCurrentLineNumber();
     IC += amount;
+    return isImageInMemory(amount);
 }
 
 /**
  * allocMemoryImg
  * --------------
- * Allocates memory for the binary and octal memory images. Initializes the binary and octal words.
- * The size of the memory images is based on the DCF (Data Counter Final).
+ * Allocates the memory image as one contiguous array of zeroed words.
+ * The size of the memory image is based on the DCF (Data Counter Final).
  */
 void allocMemoryImg()
 {
     const int totalSize = DCF - MEMORY_START; /* Calculate total size based on final data counter */
-    int i, j;
 
     /* Free previously allocated memory, if any */
-    if (binaryImg != NULL)
-        free(binaryImg);
-    if (OctalImg != NULL)
-        free(OctalImg);
+    if (memoryImg != NULL)
+        free(memoryImg);
 
-    /* Allocate memory for binary and octal images */
-    binaryImg = (BinaryWord *)malloc(totalSize * sizeof(BinaryWord));
-    OctalImg = (OctalWord *)malloc(totalSize * sizeof(OctalWord));
+    /* Allocate the image, calloc leaves every word cleared */
+    memoryImg = (Word *)calloc(totalSize > 0 ? totalSize : 1, sizeof(Word));
+}
 
-    /* Initialize binary and octal memory with default values */
-    for (i = 0; i < totalSize; i++)
-    {
-        OctalImg[i]._A = 0;
-        OctalImg[i]._B = 0;
-        OctalImg[i]._C = 0;
-        OctalImg[i]._D = 0;
-        OctalImg[i]._E = 0;
-
-        for (j = 0; j < BINARY_WORD_SIZE; j++)
-        {
-            binaryImg[i].digit[j].on = 0;
-        }
-    }
+/**
+ * getOctalDigit
+ * -------------
+ * Extracts a single octal digit of a word, the digits are numbered from the most significant (0)
+ * to the least significant (OCTAL_DIGITS_IN_WORD - 1) in the order they appear in the .ob file.
+ *
+ * Parameters:
+ * - word: The word to extract the digit from.
+ * - position: The index of the digit.
+ *
+ * Returns:
+ * - unsigned: The value of the octal digit (0 - 7).
+ */
+static unsigned getOctalDigit(Word word, int position)
+{
+    return (word >> ((OCTAL_DIGITS_IN_WORD - 1 - position) * OCTAL_DIGIT_SIZE)) & 07;
+}
+
+/**
+ * initOctalWordText
+ * -----------------
+ * Fills the octal text lookup table once, so formatting a word for the .ob file
+ * is a single table access instead of per digit conversions.
+ */
+static void initOctalWordText()
+{
+    unsigned value;
+    int position;
+
+    if (isOctalWordTextReady)
+        return;
+
+    for (value = 0; value <= WORD_MASK; value++)
+        for (position = 0; position < OCTAL_DIGITS_IN_WORD; position++)
+            octalWordText[value][position] = (char)('0' + getOctalDigit((Word)value, position));
+
+    isOctalWordTextReady = True;
 }
 
 /**
@@ -93,6 +159,23 @@ void resetMemoryCounters()
     DC = 0;
     ICF = 0;
     DCF = 0;
+    memset(instructionLines, 0, sizeof(instructionLines));
+}
+
+/**
+ * getInstructionLine
+ * ------------------
+ * Retrieves the line of the expanded file (.am) that the instruction at an address was assembled from.
+ *
+ * Parameters:
+ * - address: The address the instruction starts at.
+ *
+ * Returns:
+ * - unsigned: The line number, or 0 if no instruction starts at the address.
+ */
+unsigned getInstructionLine(unsigned address)
+{
+    return address < RAM_MEMORY_SIZE ? instructionLines[address] : 0;
 }
 
 /**
@@ -117,67 +200,51 @@ void printBinaryImg()
  * addWord
  * -------
  * Adds a word to either the code or data image depending on the DataType.
+ * The value is masked to its lowest 15 bits (two's complement for negative values)
+ * and stored directly into the image, without any intermediate representation.
  *
  * Parameters:
- * - value: The integer value to be converted and added.
+ * - value: The integer value to be added.
  * - type: The type (Code or Data) to determine where the word should be added.
  */
 void addWord(int value, DataType type)
 {
     if (type == Code)
-        addWordToCodeImage(numToBin(value));
+        addWordToCodeImage((Word)(value & WORD_MASK));
     else if (type == Data)
-        addWordToDataImage(numToBin(value));
+        addWordToDataImage((Word)(value & WORD_MASK));
 }
 
 /**
  * addWordToDataImage
  * ------------------
- * Adds a word to the data image by converting the binary string into a binary word object.
+ * Stores a word in the data image at the current data counter position.
  * Increments the data counter (DC).
  *
  * Parameters:
- * - s: The binary string representing the word.
+ * - word: The encoded word.
  */
-void addWordToDataImage(char *s)
+void addWordToDataImage(Word word)
 {
-    wordStringToWordObj(s, Data);
+    memoryImg[DC - MEMORY_START] = word;
     DC++;
+    countStat(wordsCounter, 1);
 }
 
 /**
  * addWordToCodeImage
  * ------------------
- * Adds a word to the code image by converting the binary string into a binary word object.
+ * Stores a word in the code image at the current instruction counter position.
  * Increments the instruction counter (IC).
  *
  * Parameters:
- * - s: The binary string representing the word.
+ * - word: The encoded word.
  */
-void addWordToCodeImage(char *s)
+void addWordToCodeImage(Word word)
 {
-    wordStringToWordObj(s, Code);
+    memoryImg[IC - MEMORY_START] = word;
     IC++;
-}
-
-/**
- * wordStringToWordObj
- * -------------------
- * Converts a binary string into a BinaryWord object and stores it in the appropriate location
- * (either in the code or data section based on the type).
- *
- * Parameters:
- * - s: The binary string representing the word.
- * - type: The type (Code or Data) determining where to store the binary word.
- */
-void wordStringToWordObj(char *s, DataType type)
-{
-    int j;
-    int index = type == Code ? IC - MEMORY_START : DC - MEMORY_START; /* Determine the index based on type */
-
-    /* Convert the binary string into a binary word object */
-    for (j = 0; j < BINARY_WORD_SIZE; j++)
-        binaryImg[index].digit[j].on = s[j] == '1' ? 1 : 0;
+    countStat(wordsCounter, 1);
 }
 
 /**
@@ -195,7 +262,7 @@ void printWordBinary(unsigned index)
     {
         if (j % 3 == 0)
             printf(" ");
-        printf("%d", binaryImg[index].digit[j].on ? 1 : 0);
+        printf("%d", (memoryImg[index] >> (BINARY_WORD_SIZE - 1 - j)) & 1);
     }
 
     printf("\n");
@@ -218,48 +285,85 @@ void calcFinalAddrsCountersValues()
 /**
  * printMemoryImgInRequiredObjFileFormat
  * -------------------------------------
- * Prints the memory image (both binary and octal representations) in the format required for the object file.
+ * Prints the memory image in the format required for the object file, with every octal digit labeled.
+ * The octal digits are derived from the packed words on the fly.
  */
 void printMemoryImgInRequiredObjFileFormat()
 {
-    extern BinaryWord *binaryImg;
-    extern OctalWord *OctalImg;
     int i;
     int totalSize = DCF - MEMORY_START;
 
     /* Print the size of the code and data sections */
     printf("%d %d\n", ICF - MEMORY_START, DCF - ICF);
 
-    /* Convert and print each word in octal format */
+    /* Print each word in octal format */
     for (i = 0; i < totalSize; i++)
-    {
-        OctalImg[i] = *convertBinaryWordToOctal(&binaryImg[i]);
-        printf("%04d A%x-B%x-C%x-D%x-E%x\n", MEMORY_START + i, OctalImg[i]._A, OctalImg[i]._B, OctalImg[i]._C, OctalImg[i]._D, OctalImg[i]._E);
-    }
+        printf("%04d A%x-B%x-C%x-D%x-E%x\n", MEMORY_START + i, getOctalDigit(memoryImg[i], 0), getOctalDigit(memoryImg[i], 1),
+               getOctalDigit(memoryImg[i], 2), getOctalDigit(memoryImg[i], 3), getOctalDigit(memoryImg[i], 4));
 }
 
 /**
- * writeMemoryImageToObFile
- * ------------------------
- * Writes the memory image (binary and octal representations) to the object file in the required format.
+ * getMemoryImageTextMaxLength
+ * ---------------------------
+ * Returns the size of a buffer that is large enough to hold the whole .ob file text,
+ * and so also its words lines alone.
+ */
+size_t getMemoryImageTextMaxLength()
+{
+    return (size_t)(DCF - MEMORY_START + 1) * OB_LINE_MAX_LEN;
+}
+
+/**
+ * formatMemoryImageHeader
+ * -----------------------
+ * Formats the first line of the .ob file, the sizes of the code and data sections.
  *
  * Parameters:
- * - fp: The file pointer to the object file.
+ * - dst: A buffer of at least OB_HEADER_MAX_LEN characters.
+ *
+ * Returns:
+ * - size_t: The number of characters written (no null terminator is written).
  */
-void writeMemoryImageToObFile(FILE *fp)
+size_t formatMemoryImageHeader(char *dst)
 {
-    extern BinaryWord *binaryImg;
-    extern OctalWord *OctalImg;
-    int i;
-    int totalSize = DCF - MEMORY_START;
+    char *p = dst;
 
-    /* Write the size of the code and data sections */
-    fprintf(fp, "%d %d\n", ICF - MEMORY_START, DCF - ICF);
+    p += formatDecimal(p, ICF - MEMORY_START, 1);
+    *p++ = ' ';
+    p += formatDecimal(p, DCF - ICF, 1);
+    *p++ = '\n';
+
+    return (size_t)(p - dst);
+}
+
+/**
+ * formatMemoryImageWords
+ * ----------------------
+ * Formats a line for every word of the memory image with its address and its five octal digits.
+ * The octal digits are copied from the lookup table.
+ *
+ * Parameters:
+ * - dst: A buffer of at least getMemoryImageTextMaxLength() characters.
+ *
+ * Returns:
+ * - size_t: The number of characters written (no null terminator is written).
+ */
+size_t formatMemoryImageWords(char *dst)
+{
+    unsigned i;
+    unsigned totalSize = DCF - MEMORY_START;
+    char *p = dst;
+
+    initOctalWordText();
 
-    /* Convert and write each word in octal format to the file */
     for (i = 0; i < totalSize; i++)
     {
-        OctalImg[i] = *convertBinaryWordToOctal(&binaryImg[i]);
-        fprintf(fp, "%04d %x%x%x%x%x\n", MEMORY_START + i, OctalImg[i]._A, OctalImg[i]._B, OctalImg[i]._C, OctalImg[i]._D, OctalImg[i]._E);
+        p += formatDecimal(p, MEMORY_START + i, OB_ADDRESS_MIN_DIGITS);
+        *p++ = ' ';
+        memcpy(p, octalWordText[memoryImg[i]], OCTAL_DIGITS_IN_WORD);
+        p += OCTAL_DIGITS_IN_WORD;
+        *p++ = '\n';
     }
+
+    return (size_t)(p - dst);
 }
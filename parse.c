@@ -53,7 +53,7 @@ Bool countAndVerifyDataArguments(char *line)
 
     /* If all arguments were valid, increase the data counter by the number of arguments */
     if (isValid)
-        increaseDataCounter(size);
+        isValid = increaseDataCounter(size);
 
     return isValid;
 }
@@ -184,11 +184,10 @@ Bool countAndVerifyStringArguments(char *line)
         else
         {
             size = strlen(opening) - strlen(closing); /* Calculate the size of the string */
-            increaseDataCounter(size);                /* Increase the data counter based on the string length */
+            return increaseDataCounter(size);         /* Increase the data counter based on the string length */
         }
     }
 
-    return True;
 }
 
 /**
@@ -318,6 +317,8 @@ Bool handleSingleLine(char *line)
     char *token;
     strcpy(lineCopy, line);                                                                                  /* Create a copy of the line */
     token = ((*globalState)() == firstRun) ? strtok(lineCopy, " \t\n\f\r") : strtok(lineCopy, ", \t\n\f\r"); /* Extract the first token */
+    if ((*globalState)() == firstRun && !isComment(token))
+        countStat(statementsCounter, 1);                                                                     /* Count the statement (--stats) */
     result = parseLine(token, line);                                                                         /* Parse the line */
     (*currentLineNumberPlusPlus)();                                                                          /* Increment line number */
     return result;
@@ -340,16 +341,19 @@ void parseAssemblyCode(FILE *src)
     char line[MAX_LINE_LEN] = {0};             /* Buffer for each line */
     Bool isValidCode = True;                   /* Assume the code is valid initially */
     State nextState;                           /* State to transition to after parsing */
-    char *(*fileName)() = &getFileNamePath;    /* Get the file name */
+    char *(*fileName)() = &peekFileNamePath;   /* Get the file name, without copying it */
 
     (*resetCurrentLineCounter)(); /* Reset the line counter at the beginning */
 
-    if ((*globalState)() == secondRun)
-        printf("\n\n\nSecond Run:(%s)\n", (*fileName)()); /* Output message for second run */
-    else if ((*globalState)() == firstRun)
-        printf("\n\n\nFirst Run:(%s)\n", (*fileName)()); /* Output message for first run */
+    if (isVerbose(debugVerbosity)) /* The banners are printed only with --verbosity=debug */
+    {
+        if ((*globalState)() == secondRun)
+            printf("\n\n\nSecond Run:(%s)\n", (*fileName)()); /* Output message for second run */
+        else if ((*globalState)() == firstRun)
+            printf("\n\n\nFirst Run:(%s)\n", (*fileName)()); /* Output message for first run */
+    }
 
-    while (((c = fgetc(src)) != EOF))
+    while (!isErrorLimitReached() && ((c = fgetc(src)) != EOF))
     {
         if (isspace(c) && i > 0)
             line[i++] = ' '; /* Replace multiple spaces with a single space */
@@ -371,9 +375,12 @@ void parseAssemblyCode(FILE *src)
         }
     }
 
-    if (i > 0)
+    if (i > 0 && !isErrorLimitReached())
         isValidCode = handleSingleLine(line) && isValidCode; /* Parse the last line if necessary */
 
+    if (isErrorLimitReached())
+        isValidCode = False; /* The pass was stopped by the --max-errors limit */
+
     if (!isValidCode)
         nextState = assemblyCodeFailedToCompile; /* Set the state to failure if the code is invalid */
     else
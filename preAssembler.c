@@ -5,58 +5,1079 @@ extern Bool isPossiblyUseOfMacro(char *s);
 extern Bool isMacroOpening(char *s);
 extern Bool isMacroClosing(char *s);
 extern Bool isLegalMacroName(char *s);
-extern Item *addMacro(char *name, int start, int end);
-extern Item *updateMacro(char *name, int start, int end);
+extern Item *addMacro(char *name, MacroData *data);
 extern Item *getMacro(char *s);
 
 /**
- * parseMacros
+ * The state of the macro currently being defined: its name, its parameters, whether we
+ * are inside a macro definition, the buffer its content lines are collected into, the
+ * number of lines collected and the line of its macr directive.
+ */
+static char macroName[MAX_LABEL_LEN] = {0};
+static char macroParams[MAX_MACRO_PARAMS][MAX_LABEL_LEN];
+static int macroParamCount = 0;
+static Bool isReadingMacro = False;
+static OutputBuffer macroBody = {NULL, 0, 0};
+static int macroLines = 0;
+static int macroLine = 0;
+
+/**
+ * resetMacroReading
+ * -----------------
+ * Leaves the macro definition state, releasing a body that was not handed to the macro table.
+ */
+static void resetMacroReading()
+{
+    freeOutputBuffer(&macroBody);
+    memset(macroName, 0, MAX_LABEL_LEN);
+    macroParamCount = 0;
+    macroLines = 0;
+    isReadingMacro = False;
+}
+
+/**
+ * isIdentifierCharacter
+ * ---------------------
+ * Checks if a character can be a part of a macro parameter name.
+ */
+static Bool isIdentifierCharacter(char c)
+{
+    return isalnum((unsigned char)c) || c == '_' ? True : False;
+}
+
+/**
+ * splitMacroArguments
+ * -------------------
+ * Splits a comma separated list of macro parameters or arguments in place.
+ * Each item is trimmed of surrounding blanks and must be a single non empty word.
+ *
+ * Parameters:
+ * - text: The rest of the line after the macro name (may be NULL).
+ * - items: The array that receives pointers to the items.
+ *
+ * Returns:
+ * - int: The number of items, or -1 if the list is malformed or longer than MAX_MACRO_PARAMS.
+ */
+static int splitMacroArguments(char *text, char *items[])
+{
+    int count = 0;
+    char *comma, *wordEnd;
+
+    if (text == NULL)
+        return 0;
+    while (isspace((unsigned char)*text))
+        text++;
+    if (*text == '\0')
+        return 0;
+
+    while (True)
+    {
+        if (count == MAX_MACRO_PARAMS)
+            return -1;
+        if ((comma = strchr(text, ',')) != NULL)
+            *comma = '\0';
+
+        while (isspace((unsigned char)*text))
+            text++;
+        for (wordEnd = text; *wordEnd != '\0' && !isspace((unsigned char)*wordEnd); wordEnd++)
+            ;
+        if (wordEnd == text)
+            return -1; /* Empty item, like in "a,,b" */
+
+        items[count++] = text;
+        for (text = wordEnd; isspace((unsigned char)*text); text++)
+            ;
+        if (*text != '\0')
+            return -1; /* Two words without a comma between them */
+        *wordEnd = '\0';
+
+        if (comma == NULL)
+            return count;
+        text = comma + 1;
+    }
+}
+
+/**
+ * setMacroParams
+ * --------------
+ * Stores the parameter names of the macro being defined.
+ * A parameter name is a letter or '_' followed by letters, digits and '_', and must be unique.
+ *
+ * Parameters:
+ * - text: The rest of the macro opening line after the macro name (may be NULL).
+ *
+ * Returns:
+ * - Bool: True if the parameters are legal, False otherwise.
+ */
+static Bool setMacroParams(char *text)
+{
+    char *items[MAX_MACRO_PARAMS];
+    int i, j, count = splitMacroArguments(text, items);
+
+    if (count < 0)
+        return False;
+
+    for (i = 0; i < count; i++)
+    {
+        if (strlen(items[i]) >= MAX_LABEL_LEN || isdigit((unsigned char)items[i][0]))
+            return False;
+        for (j = 0; items[i][j] != '\0'; j++)
+            if (!isIdentifierCharacter(items[i][j]))
+                return False;
+        for (j = 0; j < i; j++)
+            if (!strcmp(items[i], macroParams[j]))
+                return False;
+        strcpy(macroParams[i], items[i]);
+    }
+
+    macroParamCount = count;
+    return True;
+}
+
+/**
+ * findMacroParam
+ * --------------
+ * Finds the index of the parameter of a macro whose name is the first length characters of name.
+ *
+ * Returns:
+ * - int: The index of the parameter, or MACRO_LITERAL_SEGMENT if it is not a parameter.
+ */
+static int findMacroParam(MacroData *macro, char *name, int length)
+{
+    int i;
+    for (i = 0; i < macro->params; i++)
+        if (!strncmp(macro->paramNames[i], name, length) && macro->paramNames[i][length] == '\0')
+            return i;
+    return MACRO_LITERAL_SEGMENT;
+}
+
+/**
+ * addMacroSegment
+ * ---------------
+ * Appends a segment to a macro template, growing its array as needed.
+ * A literal run that directly follows the previous literal segment extends it.
+ *
+ * Parameters:
+ * - data: The macro whose template is built.
+ * - capacity: The number of segments the array has room for.
+ * - start, length: The run of the body the segment is made of (literal segments).
+ * - param: The parameter index, or MACRO_LITERAL_SEGMENT.
+ *
+ * Returns:
+ * - Bool: False if the memory could not be allocated.
+ */
+static Bool addMacroSegment(MacroData *data, int *capacity, int start, int length, int param)
+{
+    MacroSegment *segments, *last = data->segmentCount ? &data->segments[data->segmentCount - 1] : NULL;
+
+    if (param == MACRO_LITERAL_SEGMENT)
+    {
+        if (length == 0)
+            return True;
+        if (last != NULL && last->param == MACRO_LITERAL_SEGMENT && last->start + last->length == start)
+        {
+            last->length += length;
+            return True;
+        }
+    }
+
+    if (data->segmentCount == *capacity)
+    {
+        int newCapacity = *capacity ? *capacity * 2 : MAX_MACRO_PARAMS;
+        if ((segments = (MacroSegment *)realloc(data->segments, newCapacity * sizeof(MacroSegment))) == NULL)
+            return False;
+        data->segments = segments;
+        *capacity = newCapacity;
+    }
+
+    data->segments[data->segmentCount].start = start;
+    data->segments[data->segmentCount].length = length;
+    data->segments[data->segmentCount].param = param;
+    data->segmentCount++;
+    return True;
+}
+
+/**
+ * compileMacroTemplate
+ * --------------------
+ * Compiles the body of a macro, from index from to its end, into template segments of
+ * literal runs and parameter slots that are appended to the template of the macro.
+ * A word of the body is a parameter slot only if it is a whole identifier equal to a
+ * parameter name, and it is not inside a string (between quotes).
+ *
+ * Parameters:
+ * - data: The macro, with its body, length and parameters set.
+ * - capacity: The number of segments the template array has room for.
+ * - from: The index of the body the compilation starts from.
+ *
+ * Returns:
+ * - Bool: False if the memory could not be allocated.
+ */
+static Bool compileMacroTemplate(MacroData *data, int *capacity, int from)
+{
+    int i = from, literalStart = from, wordEnd, param;
+    Bool isInsideString = False;
+    char *body = data->body;
+
+    while (data->params > 0 && i < data->length)
+    {
+        if (body[i] == '"')
+            isInsideString = !isInsideString;
+        else if (body[i] == '\n')
+            isInsideString = False;
+        else if (!isInsideString && (isalpha((unsigned char)body[i]) || body[i] == '_') && (i == from || !isIdentifierCharacter(body[i - 1])))
+        {
+            for (wordEnd = i + 1; wordEnd < data->length && isIdentifierCharacter(body[wordEnd]); wordEnd++)
+                ;
+            if ((param = findMacroParam(data, body + i, wordEnd - i)) != MACRO_LITERAL_SEGMENT)
+            {
+                if (!addMacroSegment(data, capacity, literalStart, i - literalStart, MACRO_LITERAL_SEGMENT) ||
+                    !addMacroSegment(data, capacity, 0, 0, param))
+                    return False;
+                literalStart = wordEnd;
+            }
+            i = wordEnd;
+            continue;
+        }
+        i++;
+    }
+
+    return addMacroSegment(data, capacity, literalStart, data->length - literalStart, MACRO_LITERAL_SEGMENT);
+}
+
+/**
+ * appendToFlatMacro
+ * -----------------
+ * Appends text to the body of a macro that is being flattened. The text is compiled into the
+ * template as parameter slots of the flattened macro when isScanned is True, and as a literal run otherwise.
+ *
+ * Parameters:
+ * - flat: The flattened macro being built, its body is the buffer body.
+ * - body: The buffer of the flattened body.
+ * - capacity: The number of segments the template array of flat has room for.
+ * - text, length: The text to append.
+ * - isScanned: Whether the parameters of the flattened macro are searched in the text.
+ *
+ * Returns:
+ * - Bool: False if the memory could not be allocated.
+ */
+static Bool appendToFlatMacro(MacroData *flat, OutputBuffer *body, int *capacity, char *text, int length, Bool isScanned)
+{
+    int from = (int)body->length;
+
+    if (!reserveOutputBuffer(body, length))
+        return False;
+    memcpy(body->data + from, text, length);
+    body->length += length;
+
+    flat->body = body->data;
+    flat->length = (int)body->length;
+    return isScanned ? compileMacroTemplate(flat, capacity, from) : addMacroSegment(flat, capacity, from, length, MACRO_LITERAL_SEGMENT);
+}
+
+/**
+ * storeFlatMacro
+ * --------------
+ * Replaces the definition of a macro in the included files cache with its flattened form, so the
+ * source files that include the file later add the flattened macro without flattening it again.
+ *
+ * Parameters:
+ * - name: The name of the macro.
+ * - flat: The flattened macro, the cache takes ownership of its body, parameter names and template.
+ */
+static void storeFlatMacro(char *name, MacroData *flat)
+{
+    MacroDefinition *definition = flat->file->macros, *end = definition + flat->file->macroCount;
+
+    for (; definition < end; definition++)
+    {
+        if (!strcmp(definition->name, name))
+        {
+            free(definition->data.body);
+            free(definition->data.paramNames);
+            free(definition->data.segments);
+            definition->data = *flat;
+            definition->data.flattenState = macroFlattened;
+            flat->isShared = True;
+            return;
+        }
+    }
+}
+
+/**
+ * flattenMacro
+ * ------------
+ * Expands the uses of other macros inside the body of a macro, so the body and template of the
+ * macro become its fully expanded form. This is done once, when the macro is defined, and the
+ * result is kept in the macro table, so its uses do not expand the inner macros again.
+ * An inner macro must be defined before the macro that uses it, so every use of the macro expands
+ * the same way: a body line that starts with the name of no macro (or parameter) is reported as an error.
+ * The arguments of an inner use can be parameters of the outer macro, they become its parameter slots.
+ * A macro that uses itself is reported as an error.
+ * A macro of an included file whose inner macros are all defined in the same file expands the
+ * same way in every source file, so its flattened form is kept in the included files cache.
+ *
+ * Parameters:
+ * - macro: The macro to flatten.
+ *
+ * Returns:
+ * - Bool: True if the macro was flattened, False if an error was reported.
+ */
+static Bool flattenMacro(Item *macro)
+{
+    MacroData *data = &macro->val.m, flat, *inner;
+    OutputBuffer body;
+    char lineClone[MAX_LINE_LEN], *token, *args[MAX_MACRO_PARAMS];
+    int lineStart, lineEnd, capacity = 0;
+    Bool isNested = False, isFlattened = True, isCached = data->isShared;
+    Error err = memoryAllocationFailure;
+    MacroSegment *segment;
+    Item *p;
+
+    if (data->flattenState == macroFlattened)
+        return True;
+    if (data->flattenState == macroFlattening)
+        return reportError(macroRecursiveUse);
+
+    data->flattenState = macroFlattening;
+    initOutputBuffer(&body);
+    flat = *data;
+    flat.body = NULL;
+    flat.length = flat.lines = flat.segmentCount = 0;
+    flat.segments = NULL;
+
+    for (lineStart = 0; isFlattened && lineStart < data->length; lineStart = lineEnd)
+    {
+        for (lineEnd = lineStart; lineEnd < data->length && data->body[lineEnd++] != '\n';)
+            ;
+
+        p = NULL;
+        token = NULL;
+        if (lineEnd - lineStart < MAX_LINE_LEN)
+        {
+            memcpy(lineClone, data->body + lineStart, lineEnd - lineStart);
+            lineClone[lineEnd - lineStart] = '\0';
+            if ((token = strtok(lineClone, " \t\n\f\r")) != NULL && isPossiblyUseOfMacro(token))
+                p = getMacro(token);
+        }
+
+        if (p == NULL)
+        {
+            if (token != NULL && isPossiblyUseOfMacro(token) && findMacroParam(data, token, (int)strlen(token)) == MACRO_LITERAL_SEGMENT)
+            {
+                err = macroDoesNotExist;
+                isFlattened = False;
+            }
+            else
+            {
+                isFlattened = appendToFlatMacro(&flat, &body, &capacity, data->body + lineStart, lineEnd - lineStart, True);
+                flat.lines++;
+            }
+            continue;
+        }
+
+        isNested = True;
+        inner = &p->val.m;
+        if (splitMacroArguments(strtok(NULL, "\n"), args) != inner->params)
+        {
+            err = macroArgumentsCountMismatch;
+            isFlattened = False;
+        }
+        else if (!flattenMacro(p))
+        {
+            err = none; /* Already reported by the inner macro */
+            isFlattened = False;
+        }
+        else if (inner->file != data->file || !inner->isShared)
+            isCached = False; /* The inner macro can be another macro in another source file */
+
+        for (segment = inner->segments; isFlattened && segment < inner->segments + inner->segmentCount; segment++)
+        {
+            if (segment->param == MACRO_LITERAL_SEGMENT)
+                isFlattened = appendToFlatMacro(&flat, &body, &capacity, inner->body + segment->start, segment->length, False);
+            else
+                isFlattened = appendToFlatMacro(&flat, &body, &capacity, args[segment->param], (int)strlen(args[segment->param]), True);
+        }
+        flat.lines += inner->lines;
+    }
+
+    /* A macro of the included files cache keeps its own data, the flattened macro gets copies of the parameter names */
+    if (isFlattened && isNested && data->isShared && data->params > 0)
+    {
+        if ((flat.paramNames = malloc(data->params * sizeof(*flat.paramNames))) == NULL)
+            isFlattened = False;
+        else
+            memcpy(flat.paramNames, data->paramNames, data->params * sizeof(*flat.paramNames));
+    }
+
+    if (!isFlattened)
+    {
+        freeOutputBuffer(&body);
+        free(flat.segments);
+        data->flattenState = macroNotFlattened;
+        return err != none ? reportError(err) : False;
+    }
+
+    if (isNested)
+    {
+        if (!data->isShared)
+        {
+            free(data->body);
+            free(data->segments);
+        }
+        flat.isShared = False;
+        if (isCached)
+            storeFlatMacro(macro->name, &flat);
+        *data = flat;
+    }
+    else
+    {
+        freeOutputBuffer(&body);
+        free(flat.segments);
+    }
+    data->flattenState = macroFlattened;
+    return True;
+}
+
+/**
+ * The output of the preassembler: the expanded lines are written to the target file,
+ * or into the in memory text of an included file while it is parsed.
+ */
+static FILE *outputFile = NULL;
+static OutputBuffer *outputBuffer = NULL;
+
+/**
+ * The included files cache, kept for all the source files of the run, the included file
+ * that is parsed now (NULL while the source file itself is parsed), and the number of the
+ * current source file, so each file is included at most once in a source file.
+ */
+static IncludedFile *includeCache = NULL;
+static IncludedFile *currentInclude = NULL;
+static unsigned currentUnit = 0;
+
+/**
+ * The source lines map of the current source file: the line of the source file (.as) each line
+ * of the expanded file (.am) was written for. The lines of a macro use, or of an included file,
+ * are mapped to the line of the use or of the include directive. currentSourceLine is the line
+ * of the source file that is parsed now.
+ */
+static unsigned *sourceLines = NULL;
+static unsigned sourceLinesCount = 0, sourceLinesCapacity = 0;
+static unsigned currentSourceLine = 0;
+
+/**
+ * mapExpandedLines
+ * ----------------
+ * Maps each line that ends in a text written to the expanded file to the current line of the source file.
+ *
+ * Parameters:
+ * - text: The text that is written.
+ * - length: The number of characters in the text.
+ *
+ * Returns:
+ * - Bool: False if the memory could not be allocated.
+ */
+static Bool mapExpandedLines(char *text, size_t length)
+{
+    char *end = text + length;
+    unsigned *grown;
+
+    while ((text = (char *)memchr(text, '\n', (size_t)(end - text))) != NULL)
+    {
+        if (sourceLinesCount == sourceLinesCapacity)
+        {
+            unsigned newCapacity = sourceLinesCapacity ? sourceLinesCapacity * 2 : OUTPUT_BUFFER_INITIAL_SIZE;
+            if ((grown = (unsigned *)realloc(sourceLines, newCapacity * sizeof(unsigned))) == NULL)
+                return False;
+            sourceLines = grown;
+            sourceLinesCapacity = newCapacity;
+        }
+        sourceLines[sourceLinesCount++] = currentSourceLine;
+        text++;
+    }
+    return True;
+}
+
+/**
+ * emitText
+ * --------
+ * Writes expanded text to the current output of the preassembler.
+ *
+ * Parameters:
+ * - text: The text to write.
+ * - length: The number of characters to write.
+ */
+static void emitText(char *text, size_t length)
+{
+    void (*setState)(State) = &setGlobalState;
+
+    if (length == 0)
+        return;
+
+    if (outputBuffer == NULL)
+    {
+        fwrite(text, 1, length, outputFile);
+        if (!mapExpandedLines(text, length))
+        {
+            reportError(memoryAllocationFailure);
+            (*setState)(assemblyCodeFailedToCompile);
+        }
+    }
+    else if (!reserveOutputBuffer(outputBuffer, length))
+    {
+        reportError(memoryAllocationFailure);
+        (*setState)(assemblyCodeFailedToCompile);
+    }
+    else
+    {
+        memcpy(outputBuffer->data + outputBuffer->length, text, length);
+        outputBuffer->length += length;
+    }
+}
+
+/**
+ * isExpandedLineShort
+ * -------------------
+ * Measures the lines of an expanded text, continuing the line that the text before it left open.
+ *
+ * Parameters:
+ * - text: The text that is expanded.
+ * - length: The number of characters in the text.
+ * - lineLength: The length of the open line, updated to the length of the line the text leaves open.
+ *
+ * Returns:
+ * - Bool: False if a line is longer than the assembler reads as one line, True otherwise.
+ */
+static Bool isExpandedLineShort(char *text, size_t length, size_t *lineLength)
+{
+    char *end = text + length, *newline;
+
+    while ((newline = (char *)memchr(text, '\n', (size_t)(end - text))) != NULL)
+    {
+        if (*lineLength + (size_t)(newline - text) > MAX_LINE_LEN - 2)
+            return False;
+        *lineLength = 0;
+        text = newline + 1;
+    }
+    *lineLength += (size_t)(end - text);
+    return *lineLength <= MAX_LINE_LEN - 2 ? True : False;
+}
+
+/**
+ * expandMacro
  * -----------
- * This function handles macro parsing in the assembly source file. It checks for macro
- * declarations, verifies macro names, and processes macro invocations. If a macro is
- * detected, it is either defined or its content is substituted during the assembly process.
+ * Writes the template of a macro to the output, each parameter slot is replaced by its argument.
+ * The arguments can make a line of the expansion longer than a line of the source file, such
+ * a line is reported as an error on the line of the macro use, before the line is written.
  *
  * Parameters:
- * - line: The current line being processed.
- * - token: The first token in the line (could be a macro or regular instruction).
- * - src: The source file being parsed.
- * - target: The target file where parsed macros or instructions will be written.
+ * - macro: The macro data.
+ * - args: The arguments of the macro use, one for each parameter.
+ *
+ * Returns:
+ * - Bool: True if the macro was expanded, False if an error was reported.
  */
-void parseMacros(char *line, char *token, FILE *src, FILE *target)
+static Bool expandMacro(MacroData *macro, char *args[])
 {
+    MacroSegment *segment = macro->segments, *end = macro->segments + macro->segmentCount;
+    size_t lineLength = 0;
+    char *text;
+    size_t length;
 
-    /**
-     * Static variables to track macro name, and whether we are currently reading a macro.
-     * 'start' and 'end' store the positions in the file where the macro definition begins and ends.
-     */
-    static char macroName[MAX_LABEL_LEN] = {0}, *next;
-    static Bool isReadingMacro = False;
-    static long start = 0, end = 0;
-    void (*currentLineNumberPlusPlus)() = &increaseCurrentLineNumber;
+    countStat(macroExpansionsCounter, 1);
+    for (; segment < end; segment++)
+    {
+        text = segment->param == MACRO_LITERAL_SEGMENT ? macro->body + segment->start : args[segment->param];
+        length = segment->param == MACRO_LITERAL_SEGMENT ? (size_t)segment->length : strlen(text);
+        if (!isExpandedLineShort(text, length, &lineLength))
+            return reportError(expandedLineTooLong);
+        emitText(text, length);
+    }
+    return True;
+}
+
+/**
+ * recordIncludedMacro
+ * -------------------
+ * Moves a macro that was defined in the included file that is parsed now into the included
+ * files cache. The macro item keeps using the data, which now belongs to the cache.
+ *
+ * Parameters:
+ * - macro: The macro item that was added to the macro table.
+ *
+ * Returns:
+ * - Bool: False if the memory could not be allocated.
+ */
+static Bool recordIncludedMacro(Item *macro)
+{
+    IncludedFile *file = currentInclude;
+    MacroDefinition *macros;
+
+    if (file->macroCount == file->macroCapacity)
+    {
+        int newCapacity = file->macroCapacity ? file->macroCapacity * 2 : MAX_MACRO_PARAMS;
+        if ((macros = (MacroDefinition *)realloc(file->macros, newCapacity * sizeof(MacroDefinition))) == NULL)
+            return False;
+        file->macros = macros;
+        file->macroCapacity = newCapacity;
+    }
+
+    file->macros[file->macroCount].name = cloneString(macro->name);
+    file->macros[file->macroCount].data = macro->val.m;
+    file->macroCount++;
+    macro->val.m.isShared = True;
+    return True;
+}
+
+/**
+ * endMacroReading
+ * ---------------
+ * Compiles the macro that was read and adds it to the macro table, the table takes ownership
+ * of its body, parameter names and template (or the included files cache, if the macro is
+ * defined in an included file). The uses of other macros inside the body are expanded now,
+ * with the macros defined up to this point. The errors are reported on the line of the macr directive.
+ */
+static void endMacroReading()
+{
+    MacroData data;
+    Item *macro;
+    int capacity = 0;
+    size_t namesSize = macroParamCount * sizeof(*data.paramNames);
+    int closingLine = getCurrentLineNumber();
     void (*setState)(State) = &setGlobalState;
 
-    /**
-     * If we are not currently reading a macro and the token is not a macro opening,
-     * write the line directly to the target file and move to the next line.
-     */
-    if (!isReadingMacro)
+    setCurrentLineNumber(macroLine);
+    data.body = macroBody.data;
+    data.length = (int)macroBody.length;
+    data.lines = macroLines;
+    data.params = macroParamCount;
+    data.paramNames = NULL;
+    data.segments = NULL;
+    data.segmentCount = 0;
+    data.flattenState = macroNotFlattened;
+    data.isShared = False;
+    data.file = currentInclude;
+
+    if (namesSize > 0 && (data.paramNames = malloc(namesSize)) != NULL)
+        memcpy(data.paramNames, macroParams, namesSize);
+
+    if ((namesSize > 0 && data.paramNames == NULL) || !compileMacroTemplate(&data, &capacity, 0))
+    {
+        free(data.paramNames);
+        free(data.segments);
+        reportError(memoryAllocationFailure);
+        (*setState)(assemblyCodeFailedToCompile);
+    }
+    else if ((macro = addMacro(macroName, &data)) != NULL)
     {
-        if (!isMacroOpening(token))
+        initOutputBuffer(&macroBody); /* The body now belongs to the macro table */
+        if (currentInclude != NULL && !recordIncludedMacro(macro))
         {
-            fprintf(target, "%s", line);
-            (*currentLineNumberPlusPlus)();
+            reportError(memoryAllocationFailure);
+            (*setState)(assemblyCodeFailedToCompile);
         }
+        else if (!flattenMacro(macro))
+            (*setState)(assemblyCodeFailedToCompile);
+    }
+    else
+    {
+        free(data.paramNames);
+        free(data.segments);
+        (*setState)(assemblyCodeFailedToCompile); /* A name already in use is reported by addMacro */
+    }
+
+    resetMacroReading();
+    setCurrentLineNumber(closingLine);
+}
+
+/**
+ * freeIncludedFileContent
+ * -----------------------
+ * Frees what was kept for an included file when it was parsed, and marks it as not parsed.
+ *
+ * Parameters:
+ * - file: The included file.
+ */
+static void freeIncludedFileContent(IncludedFile *file)
+{
+    int i;
+    for (i = 0; i < file->macroCount; i++)
+    {
+        free(file->macros[i].name);
+        free(file->macros[i].data.body);
+        free(file->macros[i].data.paramNames);
+        free(file->macros[i].data.segments);
+    }
+    free(file->macros);
+    free(file->includes);
+    freeOutputBuffer(&file->text);
+
+    file->macros = NULL;
+    file->macroCount = file->macroCapacity = 0;
+    file->includes = NULL;
+    file->includeCount = file->includeCapacity = 0;
+    file->isParsed = file->isFailed = False;
+}
+
+/**
+ * getIncludedFile
+ * ---------------
+ * Finds the entry of a file in the included files cache, or adds a new (not parsed) entry for it.
+ * A file that is not parsed yet is named by the last include of it.
+ *
+ * Parameters:
+ * - path: The resolved path of the file, the entry takes ownership of it.
+ * - name: The path of the file as it is included, the entry takes ownership of it.
+ *
+ * Returns:
+ * - IncludedFile*: The entry of the file, or NULL if the memory could not be allocated.
+ */
+static IncludedFile *getIncludedFile(char *path, char *name)
+{
+    IncludedFile *file;
+
+    for (file = includeCache; file != NULL; file = file->next)
+    {
+        if (!strcmp(file->path, path))
+        {
+            free(path);
+            if (file->isParsed)
+                free(name);
+            else
+            {
+                free(file->name);
+                file->name = name;
+            }
+            return file;
+        }
+    }
+
+    if ((file = (IncludedFile *)calloc(1, sizeof(IncludedFile))) == NULL)
+    {
+        free(path);
+        free(name);
+        return NULL;
+    }
+
+    file->path = path;
+    file->name = name;
+    initOutputBuffer(&file->text);
+    file->next = includeCache;
+    includeCache = file;
+    return file;
+}
+
+/**
+ * addIncludePoint
+ * ---------------
+ * Marks the current position in the text of the included file that is parsed now as the place another file is included in.
+ *
+ * Returns:
+ * - Bool: False if the memory could not be allocated.
+ */
+static Bool addIncludePoint(IncludedFile *file)
+{
+    IncludedFile *parent = currentInclude;
+    IncludePoint *includes;
+
+    if (parent->includeCount == parent->includeCapacity)
+    {
+        int newCapacity = parent->includeCapacity ? parent->includeCapacity * 2 : MAX_MACRO_PARAMS;
+        if ((includes = (IncludePoint *)realloc(parent->includes, newCapacity * sizeof(IncludePoint))) == NULL)
+            return False;
+        parent->includes = includes;
+        parent->includeCapacity = newCapacity;
+    }
+
+    parent->includes[parent->includeCount].offset = parent->text.length;
+    parent->includes[parent->includeCount].file = file;
+    parent->includeCount++;
+    return True;
+}
+
+static void parseLines(FILE *src);
+
+/**
+ * parseIncludedFile
+ * -----------------
+ * Parses an included file for the first time. Its expanded lines are kept in its cache entry
+ * and the macros it defines are added to the macro table and to its cache entry.
+ * Errors inside the file are reported with its name and the numbers of its own lines.
+ *
+ * Parameters:
+ * - file: The cache entry of the file.
+ *
+ * Returns:
+ * - Bool: True if the file was parsed without errors, False otherwise.
+ */
+static Bool parseIncludedFile(IncludedFile *file)
+{
+    FILE *src, *previousFile = outputFile;
+    OutputBuffer *previousBuffer = outputBuffer;
+    IncludedFile *previousInclude = currentInclude;
+    int previousLine = getCurrentLineNumber();
+    char *previousPath;
+    State (*globalState)() = &getGlobalState;
+
+    if ((src = fopen(file->path, "r")) == NULL)
+    {
+        file->isFailed = True;
+        return reportError(fileCouldNotBeOpened);
+    }
+
+    previousPath = getFileNamePath();
+    outputFile = NULL;
+    outputBuffer = &file->text;
+    currentInclude = file;
+    setFileNamePath(file->name);
+
+    parseLines(src);
+    if (isReadingMacro)
+        resetMacroReading(); /* A macro that is not closed in the included file is dropped, like in a source file */
+
+    fclose(src);
+    outputFile = previousFile;
+    outputBuffer = previousBuffer;
+    currentInclude = previousInclude;
+    setFileNamePath(previousPath);
+    free(previousPath);
+    setCurrentLineNumber(previousLine);
+
+    file->isParsed = True;
+    file->isFailed = (*globalState)() == assemblyCodeFailedToCompile ? True : False;
+    return !file->isFailed;
+}
+
+/**
+ * registerIncludedFile
+ * --------------------
+ * Adds the macros of an included file, and of the files it includes, to the macro table of
+ * the current source file. A file that was not parsed yet is parsed now, the macros of a file
+ * that is already in the cache are added from the cache without parsing it again.
+ * A file whose macros were already added to the current source file is skipped.
+ *
+ * Parameters:
+ * - file: The cache entry of the file.
+ *
+ * Returns:
+ * - Bool: True if the macros were added, False if an error was reported.
+ */
+static Bool registerIncludedFile(IncludedFile *file)
+{
+    MacroData data;
+    Item *macro;
+    int i;
+
+    if (file->registeredUnit == currentUnit)
+        return True;
+    file->registeredUnit = currentUnit;
+
+    if (!file->isParsed)
+        return parseIncludedFile(file);
+
+    for (i = 0; i < file->includeCount; i++)
+        if (!registerIncludedFile(file->includes[i].file))
+            return False;
+
+    for (i = 0; i < file->macroCount; i++)
+    {
+        data = file->macros[i].data;
+        data.isShared = True;
+        if ((macro = addMacro(file->macros[i].name, &data)) == NULL || !flattenMacro(macro))
+            return False; /* A macro that uses macros of the source file is flattened in each source file */
+    }
+
+    return True;
+}
+
+/**
+ * emitIncludedFile
+ * ----------------
+ * Writes the expanded text of an included file to the output, with the files it includes
+ * in their places. A file whose text was already written to the current source file is skipped.
+ *
+ * Parameters:
+ * - file: The cache entry of the file.
+ */
+static void emitIncludedFile(IncludedFile *file)
+{
+    size_t position = 0;
+    int i;
+
+    if (file->emittedUnit == currentUnit)
+        return;
+    file->emittedUnit = currentUnit;
+
+    for (i = 0; i < file->includeCount; i++)
+    {
+        emitText(file->text.data + position, file->includes[i].offset - position);
+        emitIncludedFile(file->includes[i].file);
+        position = file->includes[i].offset;
+    }
+    emitText(file->text.data + position, file->text.length - position);
+}
+
+/**
+ * includeFile
+ * -----------
+ * Handles an include directive: .include "file". The file path is relative to the directory
+ * of the file the directive is in. The macros of the included file are added to the macro
+ * table, and its expanded text is written in place of the directive.
+ *
+ * Parameters:
+ * - text: The rest of the directive line after .include (may be NULL).
+ *
+ * Returns:
+ * - Bool: True if the file was included, False if an error was reported.
+ */
+static Bool includeFile(char *text)
+{
+    char *name, *end, *currentPath, *directoryEnd, *joined, *resolved;
+    size_t directoryLength;
+    IncludedFile *file;
+
+    if (text == NULL)
+        return reportError(expectedQuotes);
+    while (isspace((unsigned char)*text))
+        text++;
+    if (*text != '"')
+        return reportError(expectedQuotes);
+    name = text + 1;
+    if ((end = strchr(name, '"')) == NULL)
+        return reportError(closingQuotesForStringIsMissing);
+    if (end == name)
+        return reportError(emptyStringDeclatretion);
+    for (text = end + 1; isspace((unsigned char)*text); text++)
+        ;
+    if (*text != '\0')
+        return reportError(illegalApearenceOfExtraCharactersOnLine);
+    *end = '\0';
+
+    currentPath = getFileNamePath();
+    directoryEnd = *name == '/' ? NULL : strrchr(currentPath, '/');
+    directoryLength = directoryEnd != NULL ? (size_t)(directoryEnd - currentPath) + 1 : 0;
+
+    if ((joined = (char *)malloc(directoryLength + strlen(name) + 1)) == NULL)
+    {
+        free(currentPath);
+        return reportError(memoryAllocationFailure);
+    }
+    memcpy(joined, currentPath, directoryLength);
+    strcpy(joined + directoryLength, name);
+    free(currentPath);
+
+    if ((resolved = realpath(joined, NULL)) == NULL)
+    {
+        free(joined);
+        return reportError(fileCouldNotBeOpened);
     }
 
+    if ((file = getIncludedFile(resolved, joined)) == NULL || (currentInclude != NULL && !addIncludePoint(file)))
+        return reportError(memoryAllocationFailure);
+
+    if (!registerIncludedFile(file))
+        return False;
+
+    /* The text of a file included by an included file is written when the including file is written */
+    if (currentInclude == NULL)
+        emitIncludedFile(file);
+
+    return True;
+}
+
+/**
+ * getSourceLine
+ * -------------
+ * Finds the line of the source file (.as) a line of the expanded file (.am) was written for.
+ *
+ * Parameters:
+ * - expandedLine: The number of the line in the expanded file, as counted by the passes over it.
+ *
+ * Returns:
+ * - unsigned: The number of the line in the source file (the last line for a last line without a new line), or 0 if it is unknown.
+ */
+unsigned getSourceLine(unsigned expandedLine)
+{
+    if (expandedLine == 0)
+        return 0;
+    return expandedLine <= sourceLinesCount ? sourceLines[expandedLine - 1] : currentSourceLine;
+}
+
+/**
+ * freeIncludeCache
+ * ----------------
+ * Frees the included files cache and the source lines map, at the end of the run.
+ */
+void freeIncludeCache()
+{
+    IncludedFile *next;
+
+    free(sourceLines);
+    sourceLines = NULL;
+    sourceLinesCount = sourceLinesCapacity = 0;
+
+    while (includeCache != NULL)
+    {
+        next = includeCache->next;
+        freeIncludedFileContent(includeCache);
+        free(includeCache->path);
+        free(includeCache->name);
+        free(includeCache);
+        includeCache = next;
+    }
+}
+
+/**
+ * parseMacros
+ * -----------
+ * This function handles macro parsing in the assembly source file. It checks for macro
+ * declarations, verifies macro names and parameters, and processes macro invocations
+ * and include directives. The content lines of a macro are collected in memory while it
+ * is defined and compiled into a template, and each use of the macro writes that template
+ * with its arguments to the output.
+ *
+ * Parameters:
+ * - line: The current line being processed.
+ * - token: The first token in the line (could be a macro or regular instruction),
+ *          strtok continues from it to the rest of the line.
+ */
+void parseMacros(char *line, char *token)
+{
+    static char *next;
+    char *args[MAX_MACRO_PARAMS];
+    size_t length = strlen(line);
+    Item *p;
+    void (*setState)(State) = &setGlobalState;
+
     /**
-     * If the token is neither a macro use, macro opening, nor macro closing, return immediately.
+     * While reading a macro, every line up to the closing is part of the macro content.
      */
-    if (!isPossiblyUseOfMacro(token) && !isMacroOpening(token) && !isMacroClosing(token))
+    if (isReadingMacro)
+    {
+        if (isMacroClosing(token))
+            endMacroReading();
+        else if (isMacroOpening(token)) /* Error: a macro can use other macros but not define them */
+        {
+            reportError(useOfNestedMacrosIsIllegal);
+            (*setState)(assemblyCodeFailedToCompile);
+        }
+        else if (!reserveOutputBuffer(&macroBody, length))
+        {
+            reportError(memoryAllocationFailure);
+            (*setState)(assemblyCodeFailedToCompile);
+        }
+        else
+        {
+            memcpy(macroBody.data + macroBody.length, line, length);
+            macroBody.length += length;
+            macroLines++;
+        }
         return;
+    }
 
     /**
      * If a macro opening is detected, begin reading the macro.
-     * Validate the macro name, and start tracking the macro definition from the current position.
+     * Validate the macro name and parameters, and start collecting the macro content from the next line.
      */
     if (isMacroOpening(token))
     {
@@ -75,87 +1096,81 @@ void parseMacros(char *line, char *token, FILE *src, FILE *target)
             return;
         }
 
-        /**
-         * Store the start position of the macro in the source file and copy the macro name.
-         */
-        start = ftell(src);
         strcpy(macroName, next);
+        if (!setMacroParams(strtok(NULL, "\n"))) /* Error: illegal parameters list */
+        {
+            reportError(illegalMacroParameterName);
+            (*setState)(assemblyCodeFailedToCompile);
+            resetMacroReading();
+            return;
+        }
         isReadingMacro = True;
+        macroLine = getCurrentLineNumber();
+        return;
     }
+
     /**
-     * If a macro closing is detected, mark the end position of the macro,
-     * add the macro to the table, and reset variables.
+     * A closing of a macro that was never opened.
      */
-    else if (isMacroClosing(token))
+    if (isMacroClosing(token))
     {
-        end = ftell(src) - strlen(line) - 2; /* Adjust the end position to exclude the closing line */
-        addMacro(macroName, start, end);     /* Add the macro to the macro table */
-        isReadingMacro = False;
-        start = end = 0;                     /* Reset the start and end positions */
-        memset(macroName, 0, MAX_LABEL_LEN); /* Clear the macro name */
+        reportError(macroClosingWithoutAnyOpenedMacro);
+        (*setState)(assemblyCodeFailedToCompile);
+        return;
     }
+
     /**
-     * If a macro invocation is detected, replace the macro usage with its definition.
+     * An include directive is replaced by the expanded text of the included file.
      */
-    else if (isPossiblyUseOfMacro(token))
+    if (!strcmp(token, INCLUDE))
     {
-        Item *p = getMacro(token); /* Retrieve the macro definition */
-        if (p != NULL)
-        {
-            long c, toCopy = p->val.m.end - p->val.m.start; /* Calculate the length of the macro */
-            long lastPosition = 0;
-
-            /**
-             * Move the file cursor to overwrite the current line with the macro content.
-             */
-            fseek(target, -strlen(line) - 1, SEEK_CUR);
-            fprintf(target, "%s", "\0"); /* Overwrite the line */
-            lastPosition = ftell(src);   /* Save the current position in the source file */
-
-            /**
-             * Copy the macro definition from the source file to the target file.
-             */
-            fseek(src, p->val.m.start, SEEK_SET);
-            while (--toCopy && (c = fgetc(src)) != EOF)
-                fputc(c, target);
+        if (!includeFile(strtok(NULL, "\n")))
+            (*setState)(assemblyCodeFailedToCompile);
+        return;
+    }
 
-            /**
-             * Move back to the original position in the source file to continue processing.
-             */
-            fseek(src, lastPosition, SEEK_SET);
+    /**
+     * If a macro invocation is detected, replace the macro usage with its content,
+     * otherwise the line is written as is.
+     */
+    if (isPossiblyUseOfMacro(token) && (p = getMacro(token)) != NULL)
+    {
+        if (splitMacroArguments(strtok(NULL, "\n"), args) != p->val.m.params)
+        {
+            reportError(macroArgumentsCountMismatch);
+            (*setState)(assemblyCodeFailedToCompile);
+            return;
         }
+        if (!expandMacro(&p->val.m, args))
+            (*setState)(assemblyCodeFailedToCompile);
     }
+    else
+        emitText(line, length);
 }
 
 /**
- * parseSourceFile
- * ---------------
- * This function reads through the entire source file line by line, parsing each line
- * for macros and other instructions. It writes the processed output to the target file.
+ * parseLines
+ * ----------
+ * This function reads through a source (or included) file line by line, parsing each line
+ * for macros, include directives and other instructions, and writes them to the output.
+ * Every line of the file is counted, macro definitions included, so the errors are reported
+ * with the number of the line of the file they occur in.
  *
  * Parameters:
- * - src: The source file being parsed.
- * - target: The target file where the processed output will be written.
+ * - src: The file being parsed.
  */
-void parseSourceFile(FILE *src, FILE *target)
+static void parseLines(FILE *src)
 {
     char line[MAX_LINE_LEN] = {0};      /* Buffer to hold each line from the source file */
     char lineClone[MAX_LINE_LEN] = {0}; /* A clone of the line for safe tokenization */
     char *token, c;
-    int i = 0;
+    int i = 0, lineNumber = 0;
+    Bool isLineStart = True; /* False while the rest of a line that was split for its length is read */
     /**
-     * Function pointers to get and set the global state of the assembly process.
-     * setState: Used to update the current state.
-     * globalState: Used to retrieve the current state.
+     * Function pointer to get the global state of the assembly process.
      */
-    void (*setState)(State) = &setGlobalState;
     State (*globalState)() = &getGlobalState;
-    /**
-     * Function pointer to increment the line number after each successful parsing.
-     */
-    void (*resetCurrentLineCounter)() = &resetCurrentLineNumber;
-
-    (*resetCurrentLineCounter)(); /* Reset the line counter */
+    void (*setLineNumber)(int) = &setCurrentLineNumber;
 
     /**
      * Read the source file character by character until the end of the file.
@@ -171,9 +1186,9 @@ void parseSourceFile(FILE *src, FILE *target)
             c = '\n';
 
         /**
-         * If the global state indicates a failure, stop processing.
+         * If the global state indicates a failure, or the --max-errors limit was reached, stop processing.
          */
-        if ((*globalState)() == assemblyCodeFailedToCompile)
+        if ((*globalState)() == assemblyCodeFailedToCompile || isErrorLimitReached())
             return;
 
         /**
@@ -181,12 +1196,19 @@ void parseSourceFile(FILE *src, FILE *target)
          */
         if (c == '\n')
         {
+            countStat(linesCounter, 1);
+            if (isLineStart)
+                lineNumber++; /* A line that was split for its length keeps the number of its start */
+            isLineStart = line[i - 1] == '\n' ? True : False;
+            (*setLineNumber)(lineNumber);
+            if (currentInclude == NULL)
+                currentSourceLine = lineNumber;
             if (i > 0)
             {
                 strncpy(lineClone, line, i);            /* Clone the line for tokenization */
                 token = strtok(lineClone, " \t\n\f\r"); /* Get the first token */
                 if (token != NULL)
-                    parseMacros(line, token, src, target); /* Parse the line for macros */
+                    parseMacros(line, token); /* Parse the line for macros */
 
                 /**
                  * Clear the buffers and reset the index for the next line.
@@ -203,11 +1225,66 @@ void parseSourceFile(FILE *src, FILE *target)
      */
     if (i > 0)
     {
+        countStat(linesCounter, 1);
+        if (isLineStart)
+            lineNumber++;
+        (*setLineNumber)(lineNumber);
+        if (currentInclude == NULL)
+            currentSourceLine = lineNumber;
         strcpy(lineClone, line);
         token = strtok(lineClone, " \t\n\f\r");
         if (token != NULL)
-            parseMacros(line, token, src, target);
+            parseMacros(line, token);
     }
+}
+
+/**
+ * parseSourceFile
+ * ---------------
+ * This function parses the entire source file, expanding macros and include directives,
+ * and writes the processed output to the target file. The included files that failed to
+ * parse in a previous source file are parsed again when they are included.
+ *
+ * Parameters:
+ * - src: The source file being parsed.
+ * - target: The target file where the processed output will be written.
+ */
+void parseSourceFile(FILE *src, FILE *target)
+{
+    IncludedFile *file;
+    /**
+     * Function pointers to get and set the global state of the assembly process.
+     * setState: Used to update the current state.
+     * globalState: Used to retrieve the current state.
+     */
+    void (*setState)(State) = &setGlobalState;
+    State (*globalState)() = &getGlobalState;
+    /**
+     * Function pointer to increment the line number after each successful parsing.
+     */
+    void (*resetCurrentLineCounter)() = &resetCurrentLineNumber;
+
+    (*resetCurrentLineCounter)(); /* Reset the line counter */
+    resetMacroReading();          /* Drop a macro left open by a previous file */
+
+    for (file = includeCache; file != NULL; file = file->next)
+        if (file->isFailed)
+            freeIncludedFileContent(file);
+
+    currentUnit++;
+    currentInclude = NULL;
+    outputBuffer = NULL;
+    outputFile = target;
+    sourceLinesCount = 0;
+    currentSourceLine = 0;
+
+    parseLines(src);
+
+    resetMacroReading();
+    outputFile = NULL;
+
+    if (isErrorLimitReached())
+        (*setState)(assemblyCodeFailedToCompile);
 
     /**
      * If no failure occurred, set the global state to indicate the first run is complete.
@@ -0,0 +1,213 @@
+#include "data.h"
+
+/* ProfileEntry is a row of a table of the profile: an address (the end of a loop, for a loop) and its count */
+typedef struct
+{
+    unsigned address;
+    unsigned start;
+    unsigned long count;
+    unsigned long iterations;
+} ProfileEntry;
+
+/**
+ * addTopEntry
+ * -----------
+ * Adds an entry to a table of the entries with the highest counts, that is kept sorted by descending counts.
+ * The entry is dropped if the table is full and its count is not higher than the last one.
+ *
+ * Parameters:
+ * - table: The table.
+ * - length: The number of entries in the table, updated.
+ * - size: The maximal number of entries in the table.
+ * - entry: The entry.
+ */
+static void addTopEntry(ProfileEntry *table, int *length, int size, ProfileEntry entry)
+{
+    int i = *length;
+
+    if (i == size)
+    {
+        if (table[size - 1].count >= entry.count)
+            return;
+        i--;
+    }
+    else
+        (*length)++;
+
+    for (; i > 0 && table[i - 1].count < entry.count; i--)
+        table[i] = table[i - 1];
+    table[i] = entry;
+}
+
+/**
+ * formatSourceLine
+ * ----------------
+ * Formats the line of the source file (.as) the instruction at an address was assembled from.
+ *
+ * Parameters:
+ * - text: A buffer of at least MAX_DECIMAL_DIGITS + 1 characters.
+ * - address: The address of the instruction.
+ * - hasSourceLines: False if the program was loaded from a .ob file, that has no source lines.
+ *
+ * Returns:
+ * - char*: The text, "-" if the line is unknown.
+ */
+static char *formatSourceLine(char *text, unsigned address, Bool hasSourceLines)
+{
+    unsigned line = hasSourceLines ? getSourceLine(getInstructionLine(address)) : 0;
+
+    if (line == 0)
+        strcpy(text, "-");
+    else
+        sprintf(text, "%u", line);
+    return text;
+}
+
+/**
+ * formatSymbol
+ * ------------
+ * Formats an address as the symbol it is at, or as the closest symbol before it and the distance from it (LOOP+2).
+ *
+ * Parameters:
+ * - text: A buffer of at least SYMBOL_LINE_MAX_LEN characters.
+ * - address: The address.
+ * - hasSymbols: False if the program was loaded from a .ob file, that has no symbols.
+ *
+ * Returns:
+ * - char*: The text, "-" if there is no symbol at or before the address.
+ */
+static char *formatSymbol(char *text, unsigned address, Bool hasSymbols)
+{
+    Item *symbol = hasSymbols ? findSymbolByAddress(address) : NULL;
+
+    if (symbol == NULL)
+        strcpy(text, "-");
+    else if (symbol->val.s.value == address)
+        sprintf(text, "%.*s", MAX_LABEL_LEN, symbol->name);
+    else
+        sprintf(text, "%.*s+%u", MAX_LABEL_LEN, symbol->name, address - symbol->val.s.value);
+    return text;
+}
+
+/**
+ * getShare
+ * --------
+ * Returns the share of a count in the instructions the program executed, in percents.
+ */
+static double getShare(unsigned long count, unsigned long steps)
+{
+    return steps > 0 ? 100.0 * count / steps : 0;
+}
+
+/**
+ * printOpcodesHistogram
+ * ---------------------
+ * Prints how many times each opcode that ran was executed, and its share in the instructions executed.
+ */
+static void printOpcodesHistogram(Machine *machine)
+{
+    Profile *profile = machine->profile;
+    unsigned opcode;
+
+    printf("  %-8s %16s %8s\n", "opcode", "executions", "share");
+    for (opcode = 0; opcode < OP_SIZE; opcode++)
+        if (profile->opcodes[opcode] > 0)
+            printf("  %-8.4s %16lu %7.2f%%\n", getOperationByIndex(opcode)->keyword, profile->opcodes[opcode],
+                   getShare(profile->opcodes[opcode], machine->steps));
+}
+
+/**
+ * printHotAddresses
+ * -----------------
+ * Prints the PROFILE_TOP_ADDRESSES addresses whose instructions were executed the most times,
+ * with the source line, the symbol and the opcode of each instruction.
+ */
+static void printHotAddresses(Machine *machine, Bool hasSourceLines)
+{
+    ProfileEntry top[PROFILE_TOP_ADDRESSES], entry = {0, 0, 0, 0};
+    char line[MAX_DECIMAL_DIGITS + 1], symbol[SYMBOL_LINE_MAX_LEN];
+    int length = 0, i;
+
+    for (entry.address = MEMORY_START; entry.address < RAM_MEMORY_SIZE; entry.address++)
+        if ((entry.count = machine->profile->executions[entry.address]) > 0)
+            addTopEntry(top, &length, PROFILE_TOP_ADDRESSES, entry);
+
+    printf("  %-8s %8s %-16s %-8s %16s %8s\n", "address", "line", "symbol", "opcode", "executions", "share");
+    for (i = 0; i < length; i++)
+        printf("  %-8u %8s %-16s %-8.4s %16lu %7.2f%%\n", top[i].address, formatSourceLine(line, top[i].address, hasSourceLines),
+               formatSymbol(symbol, top[i].address, hasSourceLines), machine->decoded[top[i].address].opcode < OP_SIZE ? getOperationByIndex(machine->decoded[top[i].address].opcode)->keyword : "-",
+               top[i].count, getShare(top[i].count, machine->steps));
+}
+
+/**
+ * printHotLoops
+ * -------------
+ * Prints the PROFILE_TOP_LOOPS loops the program spent the most instructions in. A loop is a jmp or bne
+ * to a direct address that is not after it, and that was taken back: it spans the instructions from
+ * that address up to the jump, and each time the jump was taken back is an iteration.
+ */
+static void printHotLoops(Machine *machine, Bool hasSourceLines)
+{
+    Profile *profile = machine->profile;
+    ProfileEntry top[PROFILE_TOP_LOOPS], entry = {0, 0, 0, 0};
+    DecodedInstruction *jump;
+    char startLine[MAX_DECIMAL_DIGITS + 1], endLine[MAX_DECIMAL_DIGITS + 1], lines[2 * MAX_DECIMAL_DIGITS + 2];
+    unsigned address;
+    int length = 0, i;
+
+    for (entry.address = MEMORY_START; entry.address < RAM_MEMORY_SIZE; entry.address++)
+    {
+        jump = &machine->decoded[entry.address];
+        if (profile->backJumps[entry.address] == 0 || jump->dstKind != directOperand || jump->dst > entry.address)
+            continue;
+
+        entry.start = jump->dst;
+        entry.iterations = profile->backJumps[entry.address];
+        for (entry.count = 0, address = entry.start; address <= entry.address; address++)
+            entry.count += profile->executions[address];
+        addTopEntry(top, &length, PROFILE_TOP_LOOPS, entry);
+    }
+
+    if (length == 0)
+    {
+        printf("  no loops\n");
+        return;
+    }
+
+    printf("  %-13s %-15s %12s %16s %8s\n", "addresses", "lines", "iterations", "executions", "share");
+    for (i = 0; i < length; i++)
+    {
+        formatSourceLine(startLine, top[i].start, hasSourceLines);
+        formatSourceLine(endLine, top[i].address, hasSourceLines);
+        if (hasSourceLines)
+            sprintf(lines, "%s-%s", startLine, endLine);
+        else
+            strcpy(lines, "-");
+        printf("  %6u-%-6u %-15s %12lu %16lu %7.2f%%\n", top[i].start, top[i].address, lines,
+               top[i].iterations, top[i].count, getShare(top[i].count, machine->steps));
+    }
+}
+
+/**
+ * printProfile
+ * ------------
+ * Prints the profile of a program that ran (--profile): the executions of each opcode, the hot addresses
+ * and the hot loops. The addresses of a program that was just assembled are mapped to the lines of its
+ * source file (.as), through the lines the first pass recorded for them in the expanded file (.am),
+ * and named by its symbols, that are still in the symbol table.
+ *
+ * Parameters:
+ * - machine: The machine the program ran on, with its profile.
+ * - name: The name of the program.
+ * - hasSourceLines: True if the program is the source file that was just assembled (with its source lines and symbols).
+ */
+void printProfile(Machine *machine, char *name, Bool hasSourceLines)
+{
+    printf("\nProfile of %.*s (%lu instructions):\n", MAX_FILENAME_LEN, name, machine->steps);
+    printf("Opcodes:\n");
+    printOpcodesHistogram(machine);
+    printf("Hot addresses:\n");
+    printHotAddresses(machine, hasSourceLines);
+    printf("Hot loops:\n");
+    printHotLoops(machine, hasSourceLines);
+}
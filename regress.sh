@@ -0,0 +1,115 @@
+#!/bin/sh
+# Regression runner: assembles every sample in 00_test_files and the generated corpora,
+# compares the outputs with the goldens, and compares the throughput with the one of a base revision.
+# It fails if an output changed or if the throughput dropped by more than THRESHOLD percent from the base,
+# that is built from git and measured in the same run (alternately with this tree), so both see the same machine.
+# Usage (from the repository root): sh regress.sh [--update]
+#   --update  Rewrites the checksums in benchmarks/baseline.txt from this run (the sample goldens are only changed by hand).
+# Environment: THRESHOLD (percent, 20 by default), REGRESS_SIZES (lines of the generated corpora),
+#              BASE (the revision to compare the throughput with, HEAD by default).
+
+THRESHOLD=${THRESHOLD:-20}
+REGRESS_SIZES=${REGRESS_SIZES:-"10000 100000"}
+BASE=${BASE:-HEAD}
+BASELINE=benchmarks/baseline.txt
+RESULTS=benchmarks/results.txt
+WORK=$(mktemp -d) || exit 1
+UPDATE=0
+failures=0
+
+[ "$1" = "--update" ] && UPDATE=1
+
+trap 'rm -rf "$WORK"' EXIT
+
+# The assembler and the generator are built in a copy of the sources, so the main of the user is left as it is
+BUILD=$WORK/build
+mkdir -p "$BUILD/benchmarks" || exit 1
+cp -r makefile data.h *.c headers "$BUILD/" && cp benchmarks/generateProgram.c "$BUILD/benchmarks/" || exit 1
+(cd "$BUILD" && make -s all generateProgram > /dev/null) || exit 1
+MAIN=$BUILD/main
+
+# The assembler of the base revision; without it the throughput is only reported
+BASE_MAIN=$WORK/base/main
+mkdir -p "$WORK/base" || exit 1
+git archive "$BASE" 2>/dev/null | tar -x -C "$WORK/base" 2>/dev/null && (cd "$WORK/base" && make -s all > /dev/null 2>&1)
+[ -x "$BASE_MAIN" ] || { echo "NO BASE     could not build $BASE, the throughput is only reported"; BASE_MAIN=""; }
+
+# rate main programs...: The throughput of a run (lines per second of the phases, from the totals of --stats)
+rate() {
+    "$@" > $WORK/stats.txt 2> $WORK/errors.txt
+    awk '/^Stats for all/ { totals = 1 } totals && $1 == "total" { ms = $2 }
+         totals && $1 == "lines:" { gsub(",", ""); lines = $2 }
+         END { printf "%.0f", (ms > 0 ? lines * 1000 / ms : 0) }' $WORK/stats.txt
+}
+
+# The samples: every source file is assembled in a copy of its directory, and each golden next to it
+# (and each output that has no golden) is compared with the output of this run, with the errors logs of the included files
+cp -r 00_test_files "$WORK/" || exit 1
+for dir in errors mixed valid; do
+    (cd "$WORK/00_test_files/$dir" && rm -f *.am *.ob *.ent *.ext *.log include/*.log)
+    for source in 00_test_files/$dir/*.as; do
+        (cd "$WORK" && "$MAIN" ./${source%.as} > /dev/null 2>&1) # The logs name the files as tests.sh does
+    done
+    for output in $(cd "$WORK/00_test_files/$dir" && ls *.ob *.ent *.ext *.log include/*.log 2>/dev/null); do
+        [ -f 00_test_files/$dir/$output ] || { echo "NEW OUTPUT  00_test_files/$dir/$output"; failures=$((failures + 1)); }
+    done
+    for golden in $(cd 00_test_files/$dir && ls *.ob *.ent *.ext *.log include/*.log 2>/dev/null); do
+        if ! cmp -s 00_test_files/$dir/$golden "$WORK/00_test_files/$dir/$golden"; then
+            echo "CHANGED     00_test_files/$dir/$golden"
+            diff 00_test_files/$dir/$golden "$WORK/00_test_files/$dir/$golden" 2>&1 | head -10
+            failures=$((failures + 1))
+        fi
+    done
+done
+
+# The generated corpora: the outputs are compared by their checksum with the baseline, and the throughput
+# (the best of five runs) with the one of the base, that runs before this tree each time so the outputs checked are its own
+[ $UPDATE -eq 1 ] && : > "$WORK/baseline.txt"
+for size in $REGRESS_SIZES; do
+    programs=$(sh benchmarks/generateCorpus.sh "$BUILD/benchmarks/generateProgram" $size $WORK/program_$size) || exit 1
+
+    best=0
+    baseBest=0
+    for run in 1 2 3 4 5; do
+        if [ -n "$BASE_MAIN" ]; then
+            baseRate=$(rate "$BASE_MAIN" --stats $programs)
+            [ $baseRate -gt $baseBest ] && baseBest=$baseRate
+        fi
+        current=$(rate "$MAIN" --stats $programs)
+        [ $current -gt $best ] && best=$current
+    done
+    checksum=$(for program in $programs; do cat $program.ob $program.ent $program.ext 2>/dev/null; done | cksum | cut -d ' ' -f 1)
+    [ -s $WORK/errors.txt ] && checksum="errors"
+
+    echo "$(date '+%Y-%m-%d %H:%M') regress $size lines: $best lines/s, $BASE $baseBest lines/s" >> $RESULTS
+    if [ $UPDATE -eq 1 ]; then
+        echo "$size $checksum" >> "$WORK/baseline.txt"
+        echo "BASELINE    $size lines: checksum $checksum"
+        continue
+    fi
+
+    expectedChecksum=$(awk -v size=$size '$1 == size { print $2 }' $BASELINE 2>/dev/null)
+    if [ -z "$expectedChecksum" ]; then
+        echo "NO BASELINE $size lines (run sh regress.sh --update)"
+        failures=$((failures + 1))
+    elif [ "$checksum" != "$expectedChecksum" ]; then
+        echo "CHANGED     generated $size lines: checksum $checksum, expected $expectedChecksum"
+        failures=$((failures + 1))
+    fi
+    if [ -z "$BASE_MAIN" ]; then
+        echo "THROUGHPUT  generated $size lines: $best lines/s"
+    elif [ $((best * 100)) -lt $((baseBest * (100 - THRESHOLD))) ]; then
+        echo "SLOWER      generated $size lines: $best lines/s, $BASE $baseBest lines/s (more than $THRESHOLD% slower)"
+        failures=$((failures + 1))
+    else
+        echo "OK          generated $size lines: $best lines/s, $BASE $baseBest lines/s"
+    fi
+done
+
+[ $UPDATE -eq 1 ] && cp "$WORK/baseline.txt" $BASELINE
+
+if [ $failures -gt 0 ]; then
+    echo "$failures regression(s) found"
+    exit 1
+fi
+echo "No regressions"
@@ -4,14 +4,34 @@
  * globalState: Keeps track of the current state of the program (e.g., startProgram, firstRun, etc.).
  * path: Stores the file path of the current source file being processed.
  * currentLineNumber: Tracks the current line number in the source file.
+ * maxErrors: The number of errors reported for a file before its processing is stopped (0 for no limit).
+ * diagnosticsFormat: The format the diagnostics are written to stderr in (--diagnostics).
+ * statsEnabled: Whether the times and counters of the phases are reported (--stats).
+ * traceFile: The file the trace events of the run are written to (--trace), NULL for none.
+ * verbosity: How much is printed to stdout (--verbosity).
+ * runEnabled: Whether each assembled program is run by the emulator after its files are exported (--run).
+ * maxSteps: The number of instructions an emulated program may execute (--max-steps).
+ * profileEnabled: Whether the instructions each emulated program executes are counted and reported (--profile).
+ * batchFile: The list of the cases that are run in parallel by the emulator (--batch), NULL for none.
+ * jobs: The number of threads that run the cases of the batch (--jobs), 0 for one per processor.
  */
 static State state = startProgram;
 static char *path;
 static unsigned currentLineNumber = 1;
+static int maxErrors = 0;
+static DiagnosticsFormat diagnosticsFormat = textDiagnostics;
+static Bool statsEnabled = False;
+static char *traceFile = NULL;
+static Verbosity verbosity = normalVerbosity;
+static Bool runEnabled = False;
+static unsigned long maxSteps = EMULATOR_DEFAULT_MAX_STEPS;
+static Bool profileEnabled = False;
+static char *batchFile = NULL;
+static int jobs = 0;
 
 /**
  * setGlobalState
- * -------
+ * --------------
  * Sets the global state of the program to the new state provided as an argument.
  *
  * Parameters:
@@ -24,7 +44,7 @@ void setGlobalState(State newState)
 
 /**
  * getGlobalState
- * -------
+ * --------------
  * Retrieves the current global state of the program.
  *
  * Returns:
@@ -38,7 +58,7 @@ State getGlobalState()
 
 /**
  * setFileNamePath
- * --------
+ * ---------------
  * Sets the file path to the source file being processed. If a path already exists,
  * the function reallocates memory to accommodate the new file path.
  *
@@ -51,13 +71,13 @@ void setFileNamePath(char *s)
         return; /* If the provided string is empty, do nothing */
 
     /* Reallocate memory for the path and store the new file path */
-    path = (char *)realloc(path, strlen(s) * sizeof(char *));
-    strcpy(path, cloneString(s)); /* Clone the string and store it in 'path' */
+    path = (char *)realloc(path, strlen(s) + 1);
+    strcpy(path, s);
 }
 
 /**
  * getFileNamePath
- * --------
+ * ---------------
  * Retrieves the current file path of the source file being processed.
  *
  * Returns:
@@ -68,9 +88,23 @@ char *getFileNamePath()
     return cloneString(path); /* Return a cloned copy of the file path */
 }
 
+/**
+ * peekFileNamePath
+ * ----------------
+ * Retrieves the current file path without copying it. The returned string must not be
+ * changed or freed, and is valid until the path is set again.
+ *
+ * Returns:
+ * - char*: The current file path (NULL if no path was set yet).
+ */
+char *peekFileNamePath()
+{
+    return path;
+}
+
 /**
  * resetCurrentLineNumber
- * -----------
+ * ----------------------
  * Resets the current line number to 1. This is typically used at the start of
  * processing a new file or a new run of the assembler.
  */
@@ -79,9 +113,23 @@ void resetCurrentLineNumber()
     currentLineNumber = 1; /* Reset the line number counter to 1 */
 }
 
+/**
+ * setCurrentLineNumber
+ * --------------------
+ * Sets the current line number, used to continue counting the lines of a file
+ * after the lines of another (included) file were counted.
+ *
+ * Parameters:
+ * - lineNumber: The new current line number.
+ */
+void setCurrentLineNumber(int lineNumber)
+{
+    currentLineNumber = lineNumber; /* Restore the line number counter */
+}
+
 /**
  * increaseCurrentLineNumber
- * -------------
+ * -------------------------
  * Increments the current line number by 1. This is called after each line of code is processed.
  */
 void increaseCurrentLineNumber()
@@ -91,7 +139,7 @@ void increaseCurrentLineNumber()
 
 /**
  * getCurrentLineNumber
- * ----------
+ * --------------------
  * Retrieves the current line number being processed in the source file.
  *
  * Returns:
@@ -101,3 +149,267 @@ int getCurrentLineNumber()
 {
     return currentLineNumber; /* Return the current line number */
 }
+
+/**
+ * setMaxErrors
+ * ------------
+ * Sets the number of errors reported for a file before its processing is stopped (--max-errors).
+ *
+ * Parameters:
+ * - limit: The number of errors, 0 for no limit.
+ */
+void setMaxErrors(int limit)
+{
+    maxErrors = limit;
+}
+
+/**
+ * getMaxErrors
+ * ------------
+ * Retrieves the number of errors reported for a file before its processing is stopped.
+ *
+ * Returns:
+ * - int: The number of errors, 0 for no limit.
+ */
+int getMaxErrors()
+{
+    return maxErrors;
+}
+
+/**
+ * setDiagnosticsFormat
+ * --------------------
+ * Sets the format the diagnostics are written to stderr in (--diagnostics).
+ *
+ * Parameters:
+ * - format: The text banners, or JSON lines.
+ */
+void setDiagnosticsFormat(DiagnosticsFormat format)
+{
+    diagnosticsFormat = format;
+}
+
+/**
+ * getDiagnosticsFormat
+ * --------------------
+ * Retrieves the format the diagnostics are written to stderr in.
+ *
+ * Returns:
+ * - DiagnosticsFormat: The text banners, or JSON lines.
+ */
+DiagnosticsFormat getDiagnosticsFormat()
+{
+    return diagnosticsFormat;
+}
+
+/**
+ * setStatsEnabled
+ * ---------------
+ * Sets whether the times and counters of the phases are reported (--stats).
+ *
+ * Parameters:
+ * - isEnabled: True to report them.
+ */
+void setStatsEnabled(Bool isEnabled)
+{
+    statsEnabled = isEnabled;
+}
+
+/**
+ * isStatsEnabled
+ * --------------
+ * Checks whether the times and counters of the phases are reported.
+ *
+ * Returns:
+ * - Bool: True if --stats was given.
+ */
+Bool isStatsEnabled()
+{
+    return statsEnabled;
+}
+
+/**
+ * setTraceFile
+ * ------------
+ * Sets the file the trace events of the run are written to (--trace).
+ *
+ * Parameters:
+ * - fileName: The name of the file, that stays valid for the whole run (an argument of the program).
+ */
+void setTraceFile(char *fileName)
+{
+    traceFile = fileName;
+}
+
+/**
+ * getTraceFile
+ * ------------
+ * Retrieves the file the trace events of the run are written to.
+ *
+ * Returns:
+ * - char*: The name of the file, or NULL if --trace was not given.
+ */
+char *getTraceFile()
+{
+    return traceFile;
+}
+
+/**
+ * setVerbosity
+ * ------------
+ * Sets how much is printed to stdout (--verbosity).
+ *
+ * Parameters:
+ * - level: Nothing, one summary line per file, or also the banners and the tables.
+ */
+void setVerbosity(Verbosity level)
+{
+    verbosity = level;
+}
+
+/**
+ * isVerbose
+ * ---------
+ * Checks whether the output of a verbosity level is printed. The callers check it before
+ * formatting the output, so nothing is formatted for the levels that are not printed.
+ *
+ * Parameters:
+ * - level: The verbosity level of the output.
+ *
+ * Returns:
+ * - Bool: True if --verbosity is at this level or above it.
+ */
+Bool isVerbose(Verbosity level)
+{
+    return verbosity >= level ? True : False;
+}
+
+/**
+ * setRunEnabled
+ * -------------
+ * Sets whether each assembled program is run by the emulator after its files are exported (--run).
+ *
+ * Parameters:
+ * - isEnabled: True to run them.
+ */
+void setRunEnabled(Bool isEnabled)
+{
+    runEnabled = isEnabled;
+}
+
+/**
+ * isRunEnabled
+ * ------------
+ * Checks whether each assembled program is run by the emulator.
+ *
+ * Returns:
+ * - Bool: True if --run was given.
+ */
+Bool isRunEnabled()
+{
+    return runEnabled;
+}
+
+/**
+ * setProfileEnabled
+ * -----------------
+ * Sets whether the instructions each emulated program executes are counted and reported (--profile).
+ *
+ * Parameters:
+ * - isEnabled: True to profile them.
+ */
+void setProfileEnabled(Bool isEnabled)
+{
+    profileEnabled = isEnabled;
+}
+
+/**
+ * isProfileEnabled
+ * ----------------
+ * Checks whether the emulated programs are profiled.
+ *
+ * Returns:
+ * - Bool: True if --profile was given.
+ */
+Bool isProfileEnabled()
+{
+    return profileEnabled;
+}
+
+/**
+ * setBatchFile
+ * ------------
+ * Sets the list of the cases that are run in parallel by the emulator (--batch).
+ *
+ * Parameters:
+ * - fileName: The name of the list.
+ */
+void setBatchFile(char *fileName)
+{
+    batchFile = fileName;
+}
+
+/**
+ * getBatchFile
+ * ------------
+ * Retrieves the list of the cases that are run in parallel by the emulator.
+ *
+ * Returns:
+ * - char*: The name of the list, or NULL if --batch was not given.
+ */
+char *getBatchFile()
+{
+    return batchFile;
+}
+
+/**
+ * setJobs
+ * -------
+ * Sets the number of threads that run the cases of the batch (--jobs).
+ *
+ * Parameters:
+ * - count: The number of threads.
+ */
+void setJobs(int count)
+{
+    jobs = count;
+}
+
+/**
+ * getJobs
+ * -------
+ * Retrieves the number of threads that run the cases of the batch.
+ *
+ * Returns:
+ * - int: The number of threads, or 0 for one per processor.
+ */
+int getJobs()
+{
+    return jobs;
+}
+
+/**
+ * setMaxSteps
+ * -----------
+ * Sets the number of instructions an emulated program may execute before it is stopped (--max-steps).
+ *
+ * Parameters:
+ * - limit: The number of instructions.
+ */
+void setMaxSteps(unsigned long limit)
+{
+    maxSteps = limit;
+}
+
+/**
+ * getMaxSteps
+ * -----------
+ * Retrieves the number of instructions an emulated program may execute.
+ *
+ * Returns:
+ * - unsigned long: The number of instructions.
+ */
+unsigned long getMaxSteps()
+{
+    return maxSteps;
+}
@@ -0,0 +1,580 @@
+#include "data.h"
+
+/**
+ * fileStats: The statistics of the source file being processed.
+ * batchStats: The totals of the source files that were processed.
+ * phaseWallStart, phaseCpuStart: The times the running phase started at.
+ * runStart, fileStart: The times the run and the source file being processed started at, the trace events are relative to runStart.
+ * traceFileName: The source file being processed, as named in the trace.
+ * traceEvents: The trace events of the run, written to the --trace file at its end.
+ * currentPhase: The phase the allocations are counted for, STATS_PHASES_COUNT outside the timed phases.
+ * liveBytes: The heap memory in use, counted when built with -DTRACK_ALLOCATIONS.
+ * caseAllocations: The heap use of the cases of a --batch run, that belongs to no source file and is counted
+ * apart while isCountingCases is set.
+ * allocationsLock: Guards the allocation counters, that the threads of a --batch run update too.
+ */
+static RunStats fileStats, batchStats;
+static struct timespec phaseWallStart, runStart, fileStart;
+static clock_t phaseCpuStart;
+static char *traceFileName = "";
+static OutputBuffer traceEvents = {NULL, 0, 0};
+static int currentPhase = STATS_PHASES_COUNT;
+static long liveBytes = 0;
+static PhaseAllocations caseAllocations = {0, 0, 0};
+static Bool isCountingCases = False;
+static pthread_mutex_t allocationsLock = PTHREAD_MUTEX_INITIALIZER;
+
+static char *phaseNames[STATS_PHASES_COUNT] = {"macro expansion", "first pass", "symbol values", "second pass", "export files"};
+static char *counterNames[STATS_COUNTERS_COUNT] = {"lines", "statements", "words", "symbols", "macro expansions", "externs"};
+
+/**
+ * isTimed
+ * -------
+ * Checks if the phases are timed, which they are for --stats and for --trace.
+ */
+static Bool isTimed()
+{
+    return isStatsEnabled() || getTraceFile() != NULL ? True : False;
+}
+
+/**
+ * getMicroseconds
+ * ---------------
+ * Returns the time that passed from the start of the run to a moment, in microseconds (the unit of the trace events).
+ */
+static double getMicroseconds(struct timespec *moment)
+{
+    return (double)(moment->tv_sec - runStart.tv_sec) * 1e6 + (double)(moment->tv_nsec - runStart.tv_nsec) / 1e3;
+}
+
+/**
+ * addTraceEvent
+ * -------------
+ * Appends a complete event (a span) to the trace.
+ *
+ * Parameters:
+ * - name: The name of the span.
+ * - category: The category of the span ("file", "phase" or "case").
+ * - start: The time the span started at.
+ * - end: The time the span ended at.
+ * - file: The file the span belongs to.
+ * - thread: The trace thread of the span, TRACE_WORKER_ID for the main thread.
+ */
+static void addTraceEvent(char *name, char *category, struct timespec *start, struct timespec *end, char *file, int thread)
+{
+    char *p;
+
+    if (!reserveOutputBuffer(&traceEvents, (strlen(name) + strlen(file)) * JSON_ESCAPE_MAX_LEN + TRACE_EVENT_MAX_EXTRA_LEN))
+        return;
+
+    p = traceEvents.data + traceEvents.length;
+    p += sprintf(p, "%s{\"name\":", traceEvents.length > 0 ? ",\n" : "");
+    p += renderJsonString(p, name);
+    p += sprintf(p, ",\"cat\":\"%s\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":%d,\"tid\":%d,\"args\":{\"file\":",
+                 category, getMicroseconds(start), getMicroseconds(end) - getMicroseconds(start), TRACE_PROCESS_ID, thread);
+    p += renderJsonString(p, file);
+    p += sprintf(p, "}}");
+
+    traceEvents.length = (size_t)(p - traceEvents.data);
+}
+
+/**
+ * addTraceCounters
+ * ----------------
+ * Appends the sizes of the symbol table and of the memory image of the source file being processed
+ * at a moment to the trace, as counter events.
+ *
+ * Parameters:
+ * - moment: The time of the counters.
+ */
+static void addTraceCounters(struct timespec *moment)
+{
+    char *p;
+
+    if (!reserveOutputBuffer(&traceEvents, TRACE_EVENT_MAX_EXTRA_LEN * 2))
+        return;
+
+    p = traceEvents.data + traceEvents.length;
+    p += sprintf(p, ",\n{\"name\":\"symbol table\",\"ph\":\"C\",\"ts\":%.3f,\"pid\":%d,\"args\":{\"symbols\":%ld}}",
+                 getMicroseconds(moment), TRACE_PROCESS_ID, fileStats.counters[symbolsCounter]);
+    p += sprintf(p, ",\n{\"name\":\"memory image\",\"ph\":\"C\",\"ts\":%.3f,\"pid\":%d,\"args\":{\"words\":%ld}}",
+                 getMicroseconds(moment), TRACE_PROCESS_ID, fileStats.counters[wordsCounter]);
+
+    traceEvents.length = (size_t)(p - traceEvents.data);
+}
+
+/**
+ * startRunStats
+ * -------------
+ * Marks the start of the run, the times of the trace events are relative to it.
+ */
+void startRunStats()
+{
+    clock_gettime(CLOCK_MONOTONIC, &runStart);
+}
+
+/**
+ * startFileStats
+ * --------------
+ * Marks the start of the processing of a source file, for its span in the trace.
+ *
+ * Parameters:
+ * - fileName: The name of the source file, that is kept until flushFileStats.
+ */
+void startFileStats(char *fileName)
+{
+    traceFileName = fileName;
+    if (isTimed())
+        clock_gettime(CLOCK_MONOTONIC, &fileStart);
+}
+
+/**
+ * startPhase
+ * ----------
+ * Starts timing a phase of the current source file, if --stats or --trace was given.
+ *
+ * Parameters:
+ * - phase: The phase that starts.
+ */
+void startPhase(StatsPhase phase)
+{
+    currentPhase = phase;
+    if (!isTimed())
+        return;
+
+    clock_gettime(CLOCK_MONOTONIC, &phaseWallStart);
+    phaseCpuStart = clock();
+}
+
+/**
+ * endPhase
+ * --------
+ * Stops timing the phase that was started last, and adds its wall clock and processor times
+ * to the current source file (a phase may run more than once).
+ *
+ * Parameters:
+ * - phase: The phase that ends.
+ */
+void endPhase(StatsPhase phase)
+{
+    struct timespec now;
+    clock_t cpuNow;
+
+    currentPhase = STATS_PHASES_COUNT;
+    if (!isTimed())
+        return;
+
+    cpuNow = clock();
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    fileStats.phases[phase].wall += (double)(now.tv_sec - phaseWallStart.tv_sec) + (double)(now.tv_nsec - phaseWallStart.tv_nsec) / 1e9;
+    fileStats.phases[phase].cpu += (double)(cpuNow - phaseCpuStart) / CLOCKS_PER_SEC;
+
+    if (getTraceFile() != NULL)
+    {
+        addTraceEvent(phaseNames[phase], "phase", &phaseWallStart, &now, traceFileName, TRACE_WORKER_ID);
+        addTraceCounters(&now);
+    }
+}
+
+/**
+ * countStat
+ * ---------
+ * Adds to a counter of the current source file. The counters are kept even without --stats,
+ * since updating them costs less than checking the option.
+ *
+ * Parameters:
+ * - counter: The counter.
+ * - amount: The amount to add.
+ */
+void countStat(StatsCounter counter, long amount)
+{
+    fileStats.counters[counter] += amount;
+}
+
+/**
+ * countAllocation
+ * ---------------
+ * Counts a block that was allocated in the current phase. Any thread can allocate, so the counters are updated under their lock.
+ *
+ * Parameters:
+ * - bytes: The size of the block.
+ */
+void countAllocation(size_t bytes)
+{
+    PhaseAllocations *allocations;
+
+    pthread_mutex_lock(&allocationsLock);
+    allocations = isCountingCases ? &caseAllocations : &fileStats.allocations[currentPhase];
+    allocations->allocations++;
+    allocations->bytes += (long)bytes;
+    liveBytes += (long)bytes;
+    if (!isCountingCases && liveBytes > fileStats.peakLiveBytes)
+        fileStats.peakLiveBytes = liveBytes;
+    pthread_mutex_unlock(&allocationsLock);
+}
+
+/**
+ * countFree
+ * ---------
+ * Counts a block that was freed in the current phase.
+ *
+ * Parameters:
+ * - bytes: The size of the block.
+ */
+void countFree(size_t bytes)
+{
+    pthread_mutex_lock(&allocationsLock);
+    (isCountingCases ? &caseAllocations : &fileStats.allocations[currentPhase])->freedBytes += (long)bytes;
+    liveBytes -= (long)bytes;
+    pthread_mutex_unlock(&allocationsLock);
+}
+
+/**
+ * countCaseAllocations
+ * --------------------
+ * Starts or stops counting the allocations as the heap use of the cases of a --batch run, instead of
+ * the heap use of the current source file.
+ *
+ * Parameters:
+ * - isCounted: True while the cases run.
+ */
+void countCaseAllocations(Bool isCounted)
+{
+    pthread_mutex_lock(&allocationsLock);
+    isCountingCases = isCounted;
+    pthread_mutex_unlock(&allocationsLock);
+}
+
+/**
+ * printCaseAllocations
+ * --------------------
+ * Prints the heap use of the cases of a --batch run (with -DTRACK_ALLOCATIONS, nothing otherwise).
+ */
+void printCaseAllocations()
+{
+#ifdef TRACK_ALLOCATIONS
+    printf("  batch heap: %ld allocations, %ld bytes, %ld freed bytes\n", caseAllocations.allocations,
+           caseAllocations.bytes, caseAllocations.freedBytes);
+#endif
+}
+
+/**
+ * getAllocationsCount
+ * -------------------
+ * Returns the number of allocations that were counted for the current source file (with -DTRACK_ALLOCATIONS, 0 otherwise).
+ */
+long getAllocationsCount()
+{
+    long count = 0;
+    int i;
+
+    for (i = 0; i <= STATS_PHASES_COUNT; i++)
+        count += fileStats.allocations[i].allocations;
+    return count;
+}
+
+/**
+ * printAllocations
+ * ----------------
+ * Prints a table of the heap use of the phases (with -DTRACK_ALLOCATIONS), and the peak resident set size of the process.
+ *
+ * Parameters:
+ * - stats: The statistics to print.
+ */
+static void printAllocations(RunStats *stats)
+{
+    struct rusage usage;
+#ifdef TRACK_ALLOCATIONS
+    PhaseAllocations *allocations;
+    int i;
+
+    printf("  %-18s %12s %12s %12s %12s\n", "phase", "allocations", "bytes", "freed bytes", "live change");
+    for (i = 0; i <= STATS_PHASES_COUNT; i++)
+    {
+        allocations = &stats->allocations[i];
+        printf("  %-18s %12ld %12ld %12ld %12ld\n", i < STATS_PHASES_COUNT ? phaseNames[i] : "other", allocations->allocations,
+               allocations->bytes, allocations->freedBytes, allocations->bytes - allocations->freedBytes);
+    }
+    printf("  live bytes: %ld, peak live bytes: %ld\n", liveBytes, stats->peakLiveBytes);
+#endif
+
+    if (getrusage(RUSAGE_SELF, &usage) == 0)
+        printf("  peak RSS: %ld KB\n", (long)usage.ru_maxrss);
+}
+
+/**
+ * printStats
+ * ----------
+ * Prints a table of the times of the phases, with their sum, followed by the counters and the memory use.
+ *
+ * Parameters:
+ * - title: The line printed before the table.
+ * - stats: The statistics to print.
+ */
+static void printStats(char *title, RunStats *stats)
+{
+    PhaseTimes total = {0, 0};
+    int i;
+
+    printf("\n%s\n", title);
+    printf("  %-18s %12s %12s\n", "phase", "wall (ms)", "cpu (ms)");
+    for (i = 0; i < STATS_PHASES_COUNT; i++)
+    {
+        printf("  %-18s %12.3f %12.3f\n", phaseNames[i], stats->phases[i].wall * 1000, stats->phases[i].cpu * 1000);
+        total.wall += stats->phases[i].wall;
+        total.cpu += stats->phases[i].cpu;
+    }
+    printf("  %-18s %12.3f %12.3f\n", "total", total.wall * 1000, total.cpu * 1000);
+
+    for (i = 0; i < STATS_COUNTERS_COUNT; i++)
+        printf("%s%s: %ld", i == 0 ? "  " : ", ", counterNames[i], stats->counters[i]);
+    printf("\n");
+
+    printAllocations(stats);
+}
+
+/**
+ * flushFileStats
+ * --------------
+ * Prints the statistics of the source file that was processed (with --stats),
+ * adds them to the totals of the run, and clears them for the next file.
+ *
+ * Parameters:
+ * - fileName: The name of the source file.
+ */
+void flushFileStats(char *fileName)
+{
+    char title[MAX_FILENAME_LEN + 16];
+    struct timespec now;
+    int i;
+
+    if (getTraceFile() != NULL)
+    {
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        addTraceEvent(fileName, "file", &fileStart, &now, traceFileName, TRACE_WORKER_ID);
+    }
+
+    if (isStatsEnabled())
+    {
+        sprintf(title, "Stats for %.*s:", MAX_FILENAME_LEN, fileName);
+        printStats(title, &fileStats);
+    }
+
+    for (i = 0; i < STATS_PHASES_COUNT; i++)
+    {
+        batchStats.phases[i].wall += fileStats.phases[i].wall;
+        batchStats.phases[i].cpu += fileStats.phases[i].cpu;
+    }
+    for (i = 0; i < STATS_COUNTERS_COUNT; i++)
+        batchStats.counters[i] += fileStats.counters[i];
+    for (i = 0; i <= STATS_PHASES_COUNT; i++)
+    {
+        batchStats.allocations[i].allocations += fileStats.allocations[i].allocations;
+        batchStats.allocations[i].bytes += fileStats.allocations[i].bytes;
+        batchStats.allocations[i].freedBytes += fileStats.allocations[i].freedBytes;
+    }
+    if (fileStats.peakLiveBytes > batchStats.peakLiveBytes)
+        batchStats.peakLiveBytes = fileStats.peakLiveBytes;
+    batchStats.filesCount++;
+
+    memset(&fileStats, 0, sizeof(fileStats));
+    fileStats.peakLiveBytes = liveBytes; /* The peak of the next file starts from the memory that is still in use */
+}
+
+/**
+ * printBatchStats
+ * ---------------
+ * Prints the totals of all the source files of the run (with --stats).
+ */
+void printBatchStats()
+{
+    char title[MAX_DECIMAL_DIGITS + 32];
+
+    if (!isStatsEnabled() || batchStats.filesCount == 0) /* Only object files were run */
+        return;
+
+    sprintf(title, "Stats for all the %d source files:", batchStats.filesCount);
+    printStats(title, &batchStats);
+    printTablesHealth();
+}
+
+/**
+ * traceBatchCase
+ * --------------
+ * Appends the span of a case of a --batch run to the trace (with --trace), on the trace thread of the worker that ran it.
+ *
+ * Parameters:
+ * - name: The name of the case.
+ * - program: The .ob file of the case.
+ * - start: The time the case started at.
+ * - end: The time the case ended at.
+ * - worker: The index of the worker.
+ */
+void traceBatchCase(char *name, char *program, struct timespec *start, struct timespec *end, int worker)
+{
+    if (getTraceFile() != NULL)
+        addTraceEvent(name, "case", start, end, program, TRACE_WORKER_ID + 1 + worker);
+}
+
+/**
+ * writeTraceFile
+ * --------------
+ * Writes the trace events of the run to the --trace file, in the Chrome trace event format
+ * (that the chrome://tracing and Perfetto viewers open), and frees them.
+ */
+void writeTraceFile()
+{
+    char header[TRACE_EVENT_MAX_EXTRA_LEN], footer[] = "\n],\"displayTimeUnit\":\"ms\"}\n";
+    OutputBuffer parts[3];
+
+    if (getTraceFile() == NULL)
+        return;
+
+    parts[0].data = header;
+    parts[0].length = sprintf(header, "{\"traceEvents\":[\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%d,\"tid\":%d,\"args\":{\"name\":\"worker %d\"}}%s",
+                              TRACE_PROCESS_ID, TRACE_WORKER_ID, TRACE_WORKER_ID, traceEvents.length > 0 ? ",\n" : "");
+    parts[1] = traceEvents;
+    parts[2].data = footer;
+    parts[2].length = strlen(footer);
+
+    if (!publishOutputFile(getTraceFile(), parts, 3))
+    {
+        fprintf(stderr, "\n######################################################################\n");
+        fprintf(stderr, " ERROR: Failed to create trace file %s\n", getTraceFile());
+        fprintf(stderr, "######################################################################\n\n");
+    }
+
+    freeOutputBuffer(&traceEvents);
+}
+
+#ifdef TRACK_ALLOCATIONS
+/* The tracked allocation functions call the ones of the C library */
+#undef malloc
+#undef calloc
+#undef realloc
+#undef free
+#undef realpath
+
+/**
+ * trackedMalloc
+ * -------------
+ * Allocates a block after a header that keeps its size, and counts it.
+ *
+ * Parameters:
+ * - size: The size of the block.
+ *
+ * Returns:
+ * - void*: The block, or NULL if the memory could not be allocated.
+ */
+void *trackedMalloc(size_t size)
+{
+    AllocationHeader *header = (AllocationHeader *)malloc(sizeof(AllocationHeader) + size);
+
+    if (header == NULL)
+        return NULL;
+
+    header->size = size;
+    countAllocation(size);
+    return header + 1;
+}
+
+/**
+ * trackedCalloc
+ * -------------
+ * Allocates a block of count items that is filled with zeros, and counts it.
+ *
+ * Parameters:
+ * - count: The number of items.
+ * - size: The size of an item.
+ *
+ * Returns:
+ * - void*: The block, or NULL if the memory could not be allocated.
+ */
+void *trackedCalloc(size_t count, size_t size)
+{
+    void *block;
+
+    if (size != 0 && count > ((size_t)-1 - sizeof(AllocationHeader)) / size)
+        return NULL;
+
+    if ((block = trackedMalloc(count * size)) != NULL)
+        memset(block, 0, count * size);
+    return block;
+}
+
+/**
+ * trackedRealloc
+ * --------------
+ * Resizes a tracked block, the old size is counted as freed and the new size as allocated.
+ *
+ * Parameters:
+ * - block: The block, or NULL to allocate a new one.
+ * - size: The new size of the block.
+ *
+ * Returns:
+ * - void*: The resized block, or NULL if the memory could not be allocated (the block is kept).
+ */
+void *trackedRealloc(void *block, size_t size)
+{
+    AllocationHeader *header;
+    size_t previousSize;
+
+    if (block == NULL)
+        return trackedMalloc(size);
+
+    header = (AllocationHeader *)block - 1;
+    previousSize = header->size;
+    if ((header = (AllocationHeader *)realloc(header, sizeof(AllocationHeader) + size)) == NULL)
+        return NULL;
+
+    header->size = size;
+    countFree(previousSize);
+    countAllocation(size);
+    return header + 1;
+}
+
+/**
+ * trackedFree
+ * -----------
+ * Frees a tracked block, and counts it.
+ *
+ * Parameters:
+ * - block: The block, NULL is ignored.
+ */
+void trackedFree(void *block)
+{
+    AllocationHeader *header;
+
+    if (block == NULL)
+        return;
+
+    header = (AllocationHeader *)block - 1;
+    countFree(header->size);
+    free(header);
+}
+
+/**
+ * trackedRealpath
+ * ---------------
+ * Resolves a path into a tracked block, so it is freed like the other blocks
+ * (realpath allocates the result with the C library).
+ *
+ * Parameters:
+ * - path: The path.
+ * - resolved: Must be NULL, the result is always allocated.
+ *
+ * Returns:
+ * - char*: The resolved path, or NULL if it could not be resolved or allocated.
+ */
+char *trackedRealpath(const char *path, char *resolved)
+{
+    char *untracked = realpath(path, resolved), *copy = NULL;
+
+    if (untracked != NULL && (copy = (char *)trackedMalloc(strlen(untracked) + 1)) != NULL)
+        strcpy(copy, untracked);
+
+    free(untracked);
+    return copy;
+}
+#endif
@@ -7,12 +7,18 @@
  * - entriesCount: Counter for the number of entry symbols.
  * - externalCount: Counter for the number of external symbols.
  * - extListHead: Head of the external list.
+ * - symbolsSnapshot: The symbols sorted by address, built once after the first pass.
+ * - symbolsSnapshotCount: The number of symbols in the snapshot.
+ * - tablesHealth: The lookups and chain lengths of the macro and symbol tables over the run, indexed by ItemType.
  */
 static Item *symbols[HASHSIZE] = {0};
 static Item *macros[HASHSIZE] = {0};
 static unsigned entriesCount = 0;
 static unsigned externalCount = 0;
 static ExtListItem *extListHead = NULL;
+static Item **symbolsSnapshot = NULL;
+static unsigned symbolsSnapshotCount = 0;
+static TableHealth tablesHealth[2];
 
 extern unsigned getICF();
 extern Bool verifyLabelNaming(char *s);
@@ -48,8 +54,9 @@ void updateExtPositionData(char *name, unsigned base, unsigned offset);
  *
  * Parameters:
  * - item: Pointer to the item to free.
+ * - type: The type of the items (Symbol or Macro).
  */
-void freeTableItem(Item *item);
+void freeTableItem(Item *item, ItemType type);
 
 /**
  * findExtOpListItem
@@ -134,6 +141,7 @@ void updateExtPositionData(char *name, unsigned base, unsigned offset)
     }
 
     externalCount++; /* Increment external count */
+    countStat(externsCounter, 1);
 }
 
 /**
@@ -199,9 +207,18 @@ Item *lookup(char *s, ItemType type)
 {
     Item *np;
     int i = hash(s); /* Get the hash index */
+    TableHealth *health = &tablesHealth[type];
+
+    health->lookups++;
     for (np = (type == Symbol ? symbols[i] : macros[i]); np != NULL; np = np->next)
+    {
+        health->probes++;
         if (!strcmp(s, np->name))
+        {
+            health->hits++;
             return np; /* Return the found item if names match */
+        }
+    }
 
     return NULL;
 }
@@ -245,11 +262,20 @@ Item *install(char *name, ItemType type)
         }
         else if (type == Macro)
         {
-            np->val.m.start = -1;
-            np->val.m.end = -1;
+            np->val.m.body = NULL;
+            np->val.m.length = 0;
+            np->val.m.lines = 0;
+            np->val.m.params = 0;
+            np->val.m.paramNames = NULL;
+            np->val.m.segments = NULL;
+            np->val.m.segmentCount = 0;
+            np->val.m.flattenState = macroNotFlattened;
+            np->val.m.isShared = False;
+            np->val.m.file = NULL;
         }
 
         /* Insert the new item into the appropriate hash table */
+        tablesHealth[type].installs++;
         hashval = hash(name);
         np->next = (type == Symbol ? symbols[hashval] : macros[hashval]);
         if (type == Symbol)
@@ -296,6 +322,7 @@ Bool addSymbol(char *name, unsigned value, unsigned isCode, unsigned isData, uns
     {
         /* Install a new symbol */
         p = install(name, Symbol);
+        countStat(symbolsCounter, 1);
         offset = value % 16;
         base = value - offset;
         p->val.s.value = value;
@@ -563,7 +590,7 @@ Bool isLabelNameAlreadyTaken(char *name, ItemType type)
         }
 
         else if (type == Macro)
-            return p->val.m.start != -1 ? False : True;
+            return p->val.m.body != NULL ? False : True;
     }
 
     return False;
@@ -620,17 +647,17 @@ Item *getMacro(char *s)
 /**
  * addMacro
  * ----
- * Adds a new macro to the macro table with its start and end positions.
+ * Adds a new macro to the macro table with its body and compiled template.
+ * The macro takes ownership of the body, the parameter names and the segments, which are freed with the macro table.
  *
  * Parameters:
  * - name: The name of the macro.
- * - start: The start position of the macro.
- * - end: The end position of the macro.
+ * - data: The body (may be NULL for an empty macro) and template of the macro.
  *
  * Returns:
  * - Item*: Pointer to the newly added macro or NULL if the name is already in use.
  */
-Item *addMacro(char *name, int start, int end)
+Item *addMacro(char *name, MacroData *data)
 {
     Item *macro = lookup(name, Macro);
 
@@ -639,15 +666,8 @@ Item *addMacro(char *name, int start, int end)
         reportError(illegalMacroNameAlreadyInUse); /* Report error if the macro name is already in use */
         return NULL;
     }
-    else
-    {
-        macro = install(name, Macro);
-
-        if (start != -1)
-            macro->val.m.start = start;
-        if (end != -1)
-            macro->val.m.end = end;
-    }
+    else if ((macro = install(name, Macro)) != NULL)
+        macro->val.m = *data;
 
     return macro;
 }
@@ -655,25 +675,28 @@ Item *addMacro(char *name, int start, int end)
 /**
  * updateMacro
  * ------
- * Updates the start and end positions of an existing macro.
+ * Replaces the body and template of an existing macro, the previous ones are freed unless they are shared.
  *
  * Parameters:
  * - name: The name of the macro.
- * - start: The new start position of the macro.
- * - end: The new end position of the macro.
+ * - data: The new body and template of the macro.
  *
  * Returns:
  * - Item*: Pointer to the updated macro or NULL if not found.
  */
-Item *updateMacro(char *name, int start, int end)
+Item *updateMacro(char *name, MacroData *data)
 {
     Item *macro = getMacro(name);
     if (!macro)
         return NULL;
-    if (start != -1)
-        macro->val.m.start = start;
-    if (end != -1)
-        macro->val.m.end = end;
+
+    if (!macro->val.m.isShared)
+    {
+        free(macro->val.m.body);
+        free(macro->val.m.paramNames);
+        free(macro->val.m.segments);
+    }
+    macro->val.m = *data;
 
     return macro;
 }
@@ -682,17 +705,121 @@ Item *updateMacro(char *name, int start, int end)
  * updateFinalSymbolTableValues
  * --------------
  * Updates the final values of all symbols in the symbol table after the first pass.
- * This function adjusts the values of data symbols based on the final ICF value.
+ * This function adjusts the values of data symbols based on the final ICF value,
+ * and then builds the address sorted snapshot of the symbol table.
  */
 void updateFinalSymbolTableValues()
 {
     int i = 0;
+    Item *item;
     while (i < HASHSIZE)
     {
-        if (symbols[i] != NULL)
-            updateFinalValueOfSingleItem(symbols[i]);
+        for (item = symbols[i]; item != NULL; item = item->next)
+            updateFinalValueOfSingleItem(item);
         i++;
     }
+
+    buildSymbolsSnapshot();
+}
+
+/**
+ * compareSymbolsByAddress
+ * --------------
+ * qsort comparator of the symbols snapshot, orders the symbols by address and then by name,
+ * so the order never depends on the hash table layout.
+ */
+static int compareSymbolsByAddress(const void *a, const void *b)
+{
+    const Item *first = *(const Item *const *)a;
+    const Item *second = *(const Item *const *)b;
+
+    if (first->val.s.value != second->val.s.value)
+        return first->val.s.value < second->val.s.value ? -1 : 1;
+
+    return strcmp(first->name, second->name);
+}
+
+/**
+ * buildSymbolsSnapshot
+ * --------------
+ * Builds the symbols snapshot, an array of all the symbols in the table sorted by their address.
+ * The snapshot is built once the symbol values are final, and all the symbol table exports
+ * iterate over it instead of walking the hash chains.
+ */
+void buildSymbolsSnapshot()
+{
+    int i = 0;
+    unsigned count = 0;
+    Item *item;
+
+    freeSymbolsSnapshot();
+
+    for (i = 0; i < HASHSIZE; i++)
+        for (item = symbols[i]; item != NULL; item = item->next)
+            count++;
+
+    if (count == 0)
+        return;
+
+    if ((symbolsSnapshot = (Item **)malloc(count * sizeof(Item *))) == NULL)
+    {
+        reportError(memoryAllocationFailure);
+        return;
+    }
+
+    for (i = 0; i < HASHSIZE; i++)
+        for (item = symbols[i]; item != NULL; item = item->next)
+            symbolsSnapshot[symbolsSnapshotCount++] = item;
+
+    qsort(symbolsSnapshot, symbolsSnapshotCount, sizeof(Item *), compareSymbolsByAddress);
+}
+
+/**
+ * freeSymbolsSnapshot
+ * --------------
+ * Frees the symbols snapshot array (the symbols themselves belong to the hash table).
+ */
+void freeSymbolsSnapshot()
+{
+    free(symbolsSnapshot);
+    symbolsSnapshot = NULL;
+    symbolsSnapshotCount = 0;
+}
+
+/**
+ * findSymbolByAddress
+ * --------------
+ * Finds the code or data symbol that an address belongs to, the defined symbol with the highest
+ * address that is lower or equal to the given address, using a binary search over the snapshot.
+ * The profiler names the hot addresses of a program that was just assembled with it (e.g. LOOP+2).
+ *
+ * Parameters:
+ * - address: The memory address to look up.
+ *
+ * Returns:
+ * - Item*: The symbol, or NULL if no defined symbol starts at or below the address.
+ */
+Item *findSymbolByAddress(unsigned address)
+{
+    int low = 0, high = (int)symbolsSnapshotCount - 1, found = -1;
+
+    while (low <= high)
+    {
+        int middle = low + (high - low) / 2;
+        if (symbolsSnapshot[middle]->val.s.value <= address)
+        {
+            found = middle;
+            low = middle + 1;
+        }
+        else
+            high = middle - 1;
+    }
+
+    /* External and declared only symbols have no address of their own, skip them */
+    while (found >= 0 && !symbolsSnapshot[found]->val.s.attrs.code && !symbolsSnapshot[found]->val.s.attrs.data)
+        found--;
+
+    return found >= 0 ? symbolsSnapshot[found] : NULL;
 }
 
 /**
@@ -721,9 +848,6 @@ void updateFinalValueOfSingleItem(Item *item)
         item->val.s.base = base;
         item->val.s.value = newValue;
     }
-
-    if (item->next != NULL)
-        updateFinalValueOfSingleItem(item->next); /* Recursively update the next symbol */
 }
 
 /**
@@ -753,90 +877,101 @@ Bool areExternalsExist()
 }
 
 /**
- * writeExternalsToFile
+ * writeExternalsToBuffer
  * ----------
- * Writes all external symbols and their positions to the specified file.
+ * Writes all external symbols and their positions to the .ext output buffer.
  *
  * Parameters:
- * - fp: The file pointer to write to.
+ * - buffer: The output buffer to write to.
+ *
+ * Returns:
+ * - Bool: False if the buffer could not grow, True otherwise.
  */
-void writeExternalsToFile(FILE *fp)
+Bool writeExternalsToBuffer(OutputBuffer *buffer)
 {
     ExtListItem *p = extListHead;
     while (p != NULL)
     {
         if (p->value.base)
-            writeSingleExternal(fp, p->name, p->value.base, p->value.offset, p->value.next); /* Write each external symbol */
+        {
+            if (!writeSingleExternal(buffer, p->name, p->value.base, p->value.offset, p->value.next)) /* Write each external symbol */
+                return False;
+        }
         p = p->next;
     }
+    return True;
 }
 
 /**
  * writeSingleExternal
  * ----------
- * Writes a single external symbol and its positions to the specified file.
- * If the symbol has multiple positions, this function recursively writes them.
+ * Writes a single external symbol and its positions to the output buffer.
+ * If the symbol has multiple positions, this function writes a line for each of them.
  *
  * Parameters:
- * - fp: The file pointer to write to.
+ * - buffer: The output buffer to write to.
  * - name: The name of the external symbol.
  * - base: The base address of the symbol.
  * - offset: The offset of the symbol.
  * - next: The next position data to write (if any).
+ *
+ * Returns:
+ * - Bool: False if the buffer could not grow, True otherwise.
  */
-void writeSingleExternal(FILE *fp, char *name, unsigned base, unsigned offset, ExtPositionData *next)
+Bool writeSingleExternal(OutputBuffer *buffer, char *name, unsigned base, unsigned offset, ExtPositionData *next)
 {
-    fprintf(fp, "%s %04u\n", name, base); /* Write the external symbol and its base address */
+    if (!appendSymbolLine(buffer, name, base)) /* Write the external symbol and its base address */
+        return False;
+
+    for (; next != NULL; next = next->next)
+        if (!appendSymbolLine(buffer, name, next->base)) /* Write the next positions */
+            return False;
 
-    if (next != NULL)
-        writeSingleExternal(fp, name, next->base, next->offset, next->next); /* Recursively write next position */
+    return True;
 }
 
 /**
- * writeEntriesToFile
+ * writeEntriesToBuffer
  * ---------
- * Writes all entry symbols and their final addresses to the specified file.
+ * Writes all entry symbols and their final addresses to the .ent output buffer,
+ * in address order, by iterating over the symbols snapshot.
  *
  * Parameters:
- * - fp: The file pointer to write to.
+ * - buffer: The output buffer to write to.
+ *
+ * Returns:
+ * - Bool: False if the buffer could not grow, True otherwise.
  */
-void writeEntriesToFile(FILE *fp)
+Bool writeEntriesToBuffer(OutputBuffer *buffer)
 {
-    int i = 0;
-    int totalCount = 0;
-    while (i < HASHSIZE)
+    unsigned i = 0;
+    while (i < symbolsSnapshotCount)
     {
-        if (symbols[i] != NULL && totalCount <= entriesCount)
-            totalCount += writeSingleEntry(symbols[i], fp, 0); /* Write entry symbols */
+        if (!writeSingleEntry(symbolsSnapshot[i], buffer))
+            return False; /* Write entry symbols */
         i++;
     }
+    return True;
 }
 
 /**
  * writeSingleEntry
  * --------
- * Writes a single entry symbol and its final address to the specified file.
- * If the symbol has a linked list of items, this function recursively writes them.
+ * Writes a single symbol and its final address to the output buffer, if it is an entry symbol.
  *
  * Parameters:
  * - item: The symbol to write.
- * - fp: The file pointer to write to.
- * - count: The current count of entries written.
+ * - buffer: The output buffer to write to.
  *
  * Returns:
- * - int: The updated count of entries written.
+ * - Bool: False if the buffer could not grow, True otherwise.
  */
-int writeSingleEntry(Item *item, FILE *fp, int count)
+Bool writeSingleEntry(Item *item, OutputBuffer *buffer)
 {
-    if (item->val.s.attrs.entry)
-    {
-        fprintf(fp, "%s %04d\n", item->name, item->val.s.base + item->val.s.offset); /* Write the entry symbol */
-        count++;
-    }
-    if (item->next != NULL)
-        writeSingleEntry(item->next, fp, count); /* Recursively write next entry */
+    if (item->val.s.attrs.entry && !appendSymbolLine(buffer, item->name, item->val.s.base + item->val.s.offset))
+        return False; /* Write the entry symbol */
 
-    return count;
+    return True;
 }
 
 /**
@@ -853,6 +988,7 @@ void initTables()
         resetExtList(); /* Reset the external list */
 
     externalCount = entriesCount = 0;
+    freeSymbolsSnapshot();
     while (i < HASHSIZE)
     {
         symbols[i] = NULL;
@@ -861,6 +997,72 @@ void initTables()
     }
 }
 
+/**
+ * sampleTableHealth
+ * -------
+ * Adds the chain lengths of a table to its health: the longest chain, and the number of buckets of each length.
+ *
+ * Parameters:
+ * - type: The table (Symbol or Macro).
+ */
+static void sampleTableHealth(ItemType type)
+{
+    TableHealth *health = &tablesHealth[type];
+    Item **table = type == Symbol ? symbols : macros, *item;
+    int i, length;
+
+    for (i = 0; i < HASHSIZE; i++)
+    {
+        for (length = 0, item = table[i]; item != NULL; item = item->next)
+            length++;
+
+        if (length > health->maxChainLength)
+            health->maxChainLength = length;
+        health->chainLengths[length < TABLE_HEALTH_HISTOGRAM_SIZE ? length : TABLE_HEALTH_HISTOGRAM_SIZE - 1]++;
+    }
+    health->sampledTables++;
+}
+
+/**
+ * printTablesHealth
+ * -------
+ * Prints the health of the macro and symbol tables over the run: the lookups with their hit ratio
+ * and average probes, the installs, the longest chain, and the histogram of the buckets occupancy.
+ */
+void printTablesHealth()
+{
+    static char *names[] = {"macro", "symbol"};
+    TableHealth *health;
+    char label[MAX_DECIMAL_DIGITS + 2];
+    int type, i;
+
+    printf("  hash tables (%d buckets)\n", HASHSIZE);
+    printf("  %-8s %10s %10s %10s %10s %10s %10s\n", "table", "lookups", "hit ratio", "probes", "per lookup", "installs", "max chain");
+    for (type = Macro; type <= Symbol; type++)
+    {
+        health = &tablesHealth[type];
+        printf("  %-8s %10ld %10.3f %10ld %10.3f %10ld %10d\n", names[type], health->lookups,
+               health->lookups ? (double)health->hits / health->lookups : 0.0, health->probes,
+               health->lookups ? (double)health->probes / health->lookups : 0.0, health->installs, health->maxChainLength);
+    }
+
+    printf("  %-23s", "buckets with items:");
+    for (i = 0; i < TABLE_HEALTH_HISTOGRAM_SIZE; i++)
+    {
+        sprintf(label, "%d%s", i, i == TABLE_HEALTH_HISTOGRAM_SIZE - 1 ? "+" : "");
+        printf(" %7s", label);
+    }
+    printf("\n");
+    for (type = Macro; type <= Symbol; type++)
+    {
+        health = &tablesHealth[type];
+        printf("  %-8s %7ld tables", names[type], health->sampledTables);
+        for (i = 0; i < TABLE_HEALTH_HISTOGRAM_SIZE; i++)
+            printf(" %7ld", health->chainLengths[i]);
+        printf("\n");
+    }
+}
+
 /**
  * freeHashTable
  * -------
@@ -872,17 +1074,24 @@ void initTables()
 void freeHashTable(ItemType type)
 {
     int i = 0;
+    if (type == Symbol)
+        freeSymbolsSnapshot();
+
+    sampleTableHealth(type); /* The chains are measured once the table is complete */
+
     while (i < HASHSIZE)
     {
         if (type == Symbol)
         {
             if (symbols[i] != NULL)
-                freeTableItem(symbols[i]); /* Free symbol table items */
+                freeTableItem(symbols[i], Symbol); /* Free symbol table items */
+            symbols[i] = NULL;
         }
         else
         {
             if (macros[i] != NULL)
-                freeTableItem(macros[i]); /* Free macro table items */
+                freeTableItem(macros[i], Macro); /* Free macro table items */
+            macros[i] = NULL;
         }
         i++;
     }
@@ -891,33 +1100,45 @@ void freeHashTable(ItemType type)
 /**
  * freeTableItem
  * -------
- * Recursively frees a linked list of table items.
+ * Frees a linked list of table items with their names, and the bodies of macro items that are not shared with the included files cache.
  *
  * Parameters:
  * - item: Pointer to the item to free.
+ * - type: The type of the items (Symbol or Macro).
  */
-void freeTableItem(Item *item)
+void freeTableItem(Item *item, ItemType type)
 {
-    if (item->next != NULL)
-        freeTableItem(item->next); /* Recursively free the next item */
-    free(item);
-    return;
+    Item *next;
+    while (item != NULL)
+    {
+        next = item->next;
+        if (type == Macro && !item->val.m.isShared)
+        {
+            free(item->val.m.body);
+            free(item->val.m.paramNames);
+            free(item->val.m.segments);
+        }
+        free(item->name);
+        free(item);
+        item = next;
+    }
 }
 
 /**
  * printMacroTable
  * --------
- * Prints the macro table, including macro names and their start and end positions.
+ * Prints the macro table, including macro names, their number of parameters and the number of lines and characters of their bodies.
  */
 void printMacroTable()
 {
     int i = 0;
+    Item *item;
     printf("\n\t ~ MACRO TABLE ~ \n");
-    printf("\tname\tstart\tend");
+    printf("\tname\tparams\tlines\tlength");
     while (i < HASHSIZE)
     {
-        if (macros[i] != NULL)
-            printMacroItem(macros[i]); /* Print each macro */
+        for (item = macros[i]; item != NULL; item = item->next)
+            printMacroItem(item); /* Print each macro */
         i++;
     }
     printf("\n\n");
@@ -926,8 +1147,7 @@ void printMacroTable()
 /**
  * printMacroItem
  * -------
- * Prints a single macro's name, start, and end positions.
- * If the macro has a linked list of items, this function recursively prints them.
+ * Prints a single macro's name, its number of parameters, and the number of lines and characters of its body.
  *
  * Parameters:
  * - item: The macro to print.
@@ -937,9 +1157,7 @@ void printMacroTable()
  */
 int printMacroItem(Item *item)
 {
-    printf("\n\t%s\t %5d\t%6d", item->name, item->val.m.start, item->val.m.end); /* Print macro details */
-    if (item->next != NULL)
-        printMacroItem(item->next); /* Recursively print next macro */
+    printf("\n\t%s\t %5d\t %5d\t%6d", item->name, item->val.m.params, item->val.m.lines, item->val.m.length); /* Print macro details */
     return 0;
 }
 
@@ -947,18 +1165,18 @@ int printMacroItem(Item *item)
  * printSymbolTable
  * --------
  * Prints the symbol table, including symbol names, values, base addresses, offsets, and attributes.
+ * The symbols are printed in address order from the symbols snapshot.
  */
 void printSymbolTable()
 {
-    int i = 0;
+    unsigned i = 0;
 
     printf("\n\t\t ~ SYMBOL TABLE ~ \n");
     printf("name\tvalue\tbase\toffset\tattributes");
 
-    while (i < HASHSIZE)
+    while (i < symbolsSnapshotCount)
     {
-        if (symbols[i] != NULL)
-            printSymbolItem(symbols[i]); /* Print each symbol */
+        printSymbolItem(symbolsSnapshot[i]); /* Print each symbol */
         i++;
     }
     printf("\n\n");
@@ -968,7 +1186,6 @@ void printSymbolTable()
  * printSymbolItem
  * --------
  * Prints a single symbol's details, including its name, value, base address, offset, and attributes.
- * If the symbol has a linked list of items, this function recursively prints them.
  *
  * Parameters:
  * - item: The symbol to print.
@@ -1009,7 +1226,5 @@ int printSymbolItem(Item *item)
         }
     }
 
-    if (item->next != NULL)
-        printSymbolItem(item->next); /* Recursively print next symbol */
     return 0;
 }
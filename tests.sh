@@ -1,6 +1,6 @@
 
 cd ./00_test_files/errors
-rm -f  *.log  *.am *.ob *.ent *.ext *.warnings *.errors 
+rm -f  *.log  *.am *.ob *.ent *.ext *.warnings *.errors include/*.log
 cd ..
 
 cd ./00_test_files/mixed
@@ -14,5 +14,5 @@ cd ..
 cd ..
 
 make 
-./main ./00_test_files/errors/randomErrors  ./00_test_files/errors/wrongAddressingMethod ./00_test_files/errors/wrongNumOfCommas  ./00_test_files/errors/wrongNumOfOperands ./00_test_files/errors/wrongUseOfInstructions ./00_test_files/mixed/mixed_01 ./00_test_files/mixed/mixed_02 ./00_test_files/valid/valid_01 ./00_test_files/valid/valid_02
+./main ./00_test_files/errors/includeErrors ./00_test_files/errors/macroErrors ./00_test_files/errors/memoryErrors ./00_test_files/errors/randomErrors  ./00_test_files/errors/wrongAddressingMethod ./00_test_files/errors/wrongNumOfCommas  ./00_test_files/errors/wrongNumOfOperands ./00_test_files/errors/wrongUseOfInstructions ./00_test_files/mixed/mixed_01 ./00_test_files/mixed/mixed_02 ./00_test_files/valid/valid_01 ./00_test_files/valid/valid_02 ./00_test_files/valid/valid_03 ./00_test_files/valid/valid_04 ./00_test_files/valid/valid_05
 rm -f main
@@ -455,3 +455,42 @@ Bool verifyLabelNamingAndPrintErrors(char *s)
 
     return True;
 }
+
+/**
+ * renderJsonString
+ * ----------------
+ * Writes a string as a JSON string value, with its quotes and escapes.
+ *
+ * Parameters:
+ * - dst: The destination, with room for JSON_ESCAPE_MAX_LEN characters for each character of s, and the quotes.
+ * - s: The string.
+ *
+ * Returns:
+ * - size_t: The number of characters written.
+ */
+size_t renderJsonString(char *dst, char *s)
+{
+    char *p = dst;
+
+    *p++ = '"';
+    for (; *s != '\0'; s++)
+    {
+        if (*s == '"' || *s == '\\')
+        {
+            *p++ = '\\';
+            *p++ = *s;
+        }
+        else if (*s == '\n')
+        {
+            *p++ = '\\';
+            *p++ = 'n';
+        }
+        else if ((unsigned char)*s < ' ')
+            p += sprintf(p, "\\u%04x", (unsigned char)*s);
+        else
+            *p++ = *s;
+    }
+    *p++ = '"';
+
+    return (size_t)(p - dst);
+}